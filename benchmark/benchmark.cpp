@@ -0,0 +1,420 @@
+#include "benchmark.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <numeric>
+#include <random>
+#include <sstream>
+#include <thread>
+#include <utility>
+#include <omp.h>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace {
+    std::mutex registry_mutex;
+    std::map<std::string, PhaseStats> phase_registry;
+    std::map<std::string, uint64_t> counter_registry;
+
+    /**
+     * Escapes a string for use in JSON.
+     *
+     * @param value The string to escape.
+     * @return The quoted and escaped string.
+     */
+    std::string json_string(const std::string &value) {
+        std::string result = "\"";
+        for (const char c: value) {
+            if (c == '"' || c == '\\') {
+                result += '\\';
+            }
+            result += c;
+        }
+        return result + "\"";
+    }
+
+#ifdef __linux__
+    /**
+     * Opens a hardware perf event for the calling thread and the threads it creates afterwards.
+     *
+     * @param config The PERF_COUNT_HW_* event to count.
+     * @return The file descriptor of the event, -1 if it cannot be opened.
+     */
+    int open_perf_event(const uint64_t config) {
+        perf_event_attr attr{};
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.size = sizeof(attr);
+        attr.config = config;
+        attr.disabled = 1;
+        attr.inherit = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        return static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+    }
+
+    /**
+     * Reads the current value of a perf event.
+     *
+     * @param fd The file descriptor of the event.
+     * @return The value of the event, 0 if it cannot be read.
+     */
+    uint64_t read_perf_event(const int fd) {
+        uint64_t value = 0;
+        if (fd < 0 || read(fd, &value, sizeof(value)) != sizeof(value)) {
+            return 0;
+        }
+        return value;
+    }
+#endif
+}
+
+ScopedPhase::ScopedPhase(std::string name) : name_(std::move(name)), begin_(std::chrono::steady_clock::now()) {
+}
+
+ScopedPhase::~ScopedPhase() {
+    const double elapsed_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin_).
+            count();
+    const std::lock_guard<std::mutex> lock(registry_mutex);
+    PhaseStats &stats = phase_registry[name_];
+    stats.total_ms += elapsed_ms;
+    ++stats.count;
+}
+
+/**
+ * Adds a value to the named work counter.
+ *
+ * @param name The name of the counter.
+ * @param value The value to add.
+ */
+void add_counter(const std::string &name, const uint64_t value) {
+    const std::lock_guard<std::mutex> lock(registry_mutex);
+    counter_registry[name] += value;
+}
+
+/**
+ * Returns a copy of the accumulated phases.
+ *
+ * @return The phases by name.
+ */
+std::map<std::string, PhaseStats> get_phase_stats() {
+    const std::lock_guard<std::mutex> lock(registry_mutex);
+    return phase_registry;
+}
+
+/**
+ * Returns a copy of the work counters.
+ *
+ * @return The counters by name.
+ */
+std::map<std::string, uint64_t> get_counters() {
+    const std::lock_guard<std::mutex> lock(registry_mutex);
+    return counter_registry;
+}
+
+/**
+ * Clears all accumulated phases and work counters.
+ */
+void reset_instrumentation() {
+    const std::lock_guard<std::mutex> lock(registry_mutex);
+    phase_registry.clear();
+    counter_registry.clear();
+}
+
+/**
+ * Prints the accumulated phases and work counters.
+ *
+ * @param out The stream to print to.
+ */
+void print_phase_summary(std::ostream &out) {
+    const std::map<std::string, PhaseStats> phases = get_phase_stats();
+    const std::map<std::string, uint64_t> counters = get_counters();
+    if (phases.empty() && counters.empty()) {
+        return;
+    }
+
+    out << "Phase timings:" << std::endl;
+    for (const auto &[name, stats]: phases) {
+        out << "  " << name << ": " << stats.total_ms << "ms (" << stats.count << "x)" << std::endl;
+    }
+    for (const auto &[name, value]: counters) {
+        out << "  " << name << ": " << value << std::endl;
+    }
+}
+
+PerfCounters::PerfCounters() {
+#ifdef __linux__
+    cycles_fd_ = open_perf_event(PERF_COUNT_HW_CPU_CYCLES);
+    llc_misses_fd_ = open_perf_event(PERF_COUNT_HW_CACHE_MISSES);
+#endif
+}
+
+PerfCounters::~PerfCounters() {
+#ifdef __linux__
+    for (const int fd: {cycles_fd_, llc_misses_fd_}) {
+        if (fd >= 0) {
+            close(fd);
+        }
+    }
+#endif
+}
+
+/**
+ * Resets and enables the counters.
+ */
+void PerfCounters::start() const {
+#ifdef __linux__
+    if (available()) {
+        for (const int fd: {cycles_fd_, llc_misses_fd_}) {
+            ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+            ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+        }
+    }
+#endif
+}
+
+/**
+ * Disables the counters, the values stay readable.
+ */
+void PerfCounters::stop() const {
+#ifdef __linux__
+    if (available()) {
+        for (const int fd: {cycles_fd_, llc_misses_fd_}) {
+            ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+        }
+    }
+#endif
+}
+
+uint64_t PerfCounters::cycles() const {
+#ifdef __linux__
+    return available() ? read_perf_event(cycles_fd_) : 0;
+#else
+    return 0;
+#endif
+}
+
+uint64_t PerfCounters::llc_misses() const {
+#ifdef __linux__
+    return available() ? read_perf_event(llc_misses_fd_) : 0;
+#else
+    return 0;
+#endif
+}
+
+TeamPerfCounters::TeamPerfCounters(const int threads) {
+#pragma omp parallel num_threads(threads) default(none) shared(counters_)
+    {
+#pragma omp single
+        counters_.resize(omp_get_num_threads());
+
+        counters_[omp_get_thread_num()] = std::make_unique<PerfCounters>();
+    }
+}
+
+bool TeamPerfCounters::available() const {
+    return std::all_of(counters_.begin(), counters_.end(), [](const std::unique_ptr<PerfCounters> &counters) {
+        return counters && counters->available();
+    });
+}
+
+/**
+ * Resets and enables the counters of all team threads.
+ */
+void TeamPerfCounters::start() const {
+    for (const auto &counters: counters_) {
+        counters->start();
+    }
+}
+
+/**
+ * Disables the counters of all team threads, the values stay readable.
+ */
+void TeamPerfCounters::stop() const {
+    for (const auto &counters: counters_) {
+        counters->stop();
+    }
+}
+
+uint64_t TeamPerfCounters::cycles() const {
+    uint64_t total = 0;
+    for (const auto &counters: counters_) {
+        total += counters->cycles();
+    }
+    return total;
+}
+
+uint64_t TeamPerfCounters::llc_misses() const {
+    uint64_t total = 0;
+    for (const auto &counters: counters_) {
+        total += counters->llc_misses();
+    }
+    return total;
+}
+
+/**
+ * Writes the benchmark results to a JSON file, one object per run tagged with its (strong or weak) scaling sweep.
+ *
+ * @param filename The name of the file to write to.
+ * @param results The results of all runs.
+ * @return True if the results were written successfully.
+ */
+bool write_benchmark_json(const std::string &filename, const std::vector<BenchmarkResult> &results) {
+    std::ofstream file(filename);
+    if (!file.is_open()) {
+        std::cerr << "Error opening file: " << filename << std::endl;
+        return false;
+    }
+
+    file << std::setprecision(10);
+    file << "{\n  \"hardware_concurrency\": " << std::thread::hardware_concurrency() << ",\n  \"results\": [";
+    for (size_t i = 0; i < results.size(); ++i) {
+        const BenchmarkResult &result = results[i];
+        file << (i == 0 ? "\n" : ",\n") << "    {\"kernel\": " << json_string(result.kernel)
+                << ", \"scaling\": " << json_string(result.scaling) << ", \"threads\": " << result.threads
+                << ", \"size\": " << result.size
+                << ", \"total_ms\": " << result.total_ms << ", \"throughput\": " << result.throughput
+                << ", \"throughput_unit\": " << json_string(result.throughput_unit) << ",\n     \"phases\": {";
+
+        bool first = true;
+        for (const auto &[name, stats]: result.phases) {
+            file << (first ? "" : ", ") << json_string(name) << ": {\"total_ms\": " << stats.total_ms
+                    << ", \"count\": " << stats.count << "}";
+            first = false;
+        }
+        file << "},\n     \"counters\": {";
+        first = true;
+        for (const auto &[name, value]: result.counters) {
+            file << (first ? "" : ", ") << json_string(name) << ": " << value;
+            first = false;
+        }
+        file << "},\n     \"perf\": ";
+        if (result.perf_available) {
+            file << "{\"cycles\": " << result.cycles << ", \"llc_misses\": " << result.llc_misses << "}}";
+        } else {
+            file << "null}";
+        }
+    }
+    file << "\n  ]\n}\n";
+
+    return file.good();
+}
+
+/**
+ * Generates a random SRFLP instance with faculty sizes 1-10 and weights 0-10 above the main diagonal.
+ *
+ * @param faculties The number of faculties.
+ * @param seed The seed of the random generator.
+ * @return The generated instance.
+ */
+SrflpInstance generate_srflp_instance(const size_t faculties, const unsigned seed) {
+    std::mt19937 generator(seed);
+    std::uniform_int_distribution<int> size_distribution(1, 10);
+    std::uniform_int_distribution<int> weight_distribution(0, 10);
+
+    SrflpInstance instance;
+    instance.faculty_sizes.resize(faculties);
+    instance.weights_matrix.assign(faculties, std::vector<int>(faculties, 0));
+    for (size_t i = 0; i < faculties; ++i) {
+        instance.faculty_sizes[i] = size_distribution(generator);
+        for (size_t j = i + 1; j < faculties; ++j) {
+            instance.weights_matrix[i][j] = weight_distribution(generator);
+        }
+    }
+    return instance;
+}
+
+/**
+ * Generates points around randomly placed cluster centres (Gaussian noise with unit deviation).
+ *
+ * @param points The number of points.
+ * @param dimensions The number of dimensions of every point.
+ * @param clusters The number of clusters.
+ * @param seed The seed of the random generator.
+ * @return The generated points.
+ */
+std::vector<std::vector<double> > generate_clustered_points(const size_t points,
+                                                            const size_t dimensions,
+                                                            const size_t clusters,
+                                                            const unsigned seed) {
+    std::mt19937 generator(seed);
+    std::uniform_real_distribution<double> centre_distribution(-50.0, 50.0);
+    std::normal_distribution<double> noise_distribution(0.0, 1.0);
+
+    std::vector<std::vector<double> > centres(std::max<size_t>(clusters, 1), std::vector<double>(dimensions));
+    for (auto &centre: centres) {
+        for (double &coordinate: centre) {
+            coordinate = centre_distribution(generator);
+        }
+    }
+
+    std::vector<std::vector<double> > result(points, std::vector<double>(dimensions));
+    for (size_t i = 0; i < points; ++i) {
+        const std::vector<double> &centre = centres[i % centres.size()];
+        for (size_t d = 0; d < dimensions; ++d) {
+            result[i][d] = centre[d] + noise_distribution(generator);
+        }
+    }
+    return result;
+}
+
+/**
+ * Writes a random directed graph with power-law in-degrees in the format of the SNAP web graphs.
+ *
+ * Every node links to the next one (so all node IDs appear in the file) and to a random number of targets chosen with
+ * a heavily skewed distribution. Hub IDs are scattered by a random permutation, like in crawled web graphs.
+ *
+ * @param filename The name of the file to write to.
+ * @param nodes The number of nodes.
+ * @param average_degree The average out-degree of a node.
+ * @param seed The seed of the random generator.
+ * @return True if the graph was written successfully.
+ */
+bool write_power_law_graph(const std::string &filename,
+                           const size_t nodes,
+                           const size_t average_degree,
+                           const unsigned seed) {
+    std::ofstream file(filename);
+    if (!file.is_open()) {
+        std::cerr << "Error opening file: " << filename << std::endl;
+        return false;
+    }
+
+    std::mt19937 generator(seed);
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+    std::poisson_distribution<size_t> degree_distribution(static_cast<double>(std::max<size_t>(average_degree, 1) - 1));
+
+    std::vector<int> hubs(nodes);
+    std::iota(hubs.begin(), hubs.end(), 0);
+    std::shuffle(hubs.begin(), hubs.end(), generator);
+
+    file << "# Synthetic power-law graph\n# FromNodeId\tToNodeId\n";
+    std::ostringstream buffer;
+    for (size_t source = 0; source < nodes; ++source) {
+        buffer << source << '\t' << (source + 1) % nodes << '\n';
+        const size_t degree = degree_distribution(generator);
+        for (size_t e = 0; e < degree; ++e) {
+            const auto rank = static_cast<size_t>(static_cast<double>(nodes) * std::pow(uniform(generator), 3.0));
+            if (const int target = hubs[std::min(rank, nodes - 1)]; static_cast<size_t>(target) != source) {
+                buffer << source << '\t' << target << '\n';
+            }
+        }
+
+        if (buffer.tellp() > (1 << 20)) {
+            file << buffer.str();
+            buffer.str("");
+        }
+    }
+    file << buffer.str();
+
+    return file.good();
+}
@@ -0,0 +1,126 @@
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+
+/**
+ * Structure to hold the accumulated time of one instrumented phase.
+ */
+struct PhaseStats {
+    double total_ms = 0.0; ///< Total time spent in the phase.
+    long count = 0; ///< Number of times the phase was entered.
+};
+
+/**
+ * Timer recording the time between its construction and destruction as one run of the named phase.
+ *
+ * Phases are accumulated in a process-wide registry, so the hot paths of the kernels can be instrumented without
+ * passing any state around. It is meant for coarse phases (loading, one iteration), not for inner loops.
+ */
+class ScopedPhase {
+public:
+    explicit ScopedPhase(std::string name);
+    ~ScopedPhase();
+
+    ScopedPhase(const ScopedPhase &) = delete;
+    ScopedPhase &operator=(const ScopedPhase &) = delete;
+
+private:
+    std::string name_;
+    std::chrono::steady_clock::time_point begin_;
+};
+
+// Registry of the instrumented phases and work counters (e.g. processed edges)
+void add_counter(const std::string &name, uint64_t value);
+std::map<std::string, PhaseStats> get_phase_stats();
+std::map<std::string, uint64_t> get_counters();
+void reset_instrumentation();
+void print_phase_summary(std::ostream &out);
+
+/**
+ * Hardware performance counters (CPU cycles and last level cache misses) read via perf_event_open.
+ *
+ * The counters follow the thread that created them and the threads it creates afterwards (they are summed when these
+ * threads exit). Where perf events are not supported or not permitted, available() returns false and all values are 0.
+ */
+class PerfCounters {
+public:
+    PerfCounters();
+    ~PerfCounters();
+
+    PerfCounters(const PerfCounters &) = delete;
+    PerfCounters &operator=(const PerfCounters &) = delete;
+
+    [[nodiscard]] bool available() const { return cycles_fd_ >= 0 && llc_misses_fd_ >= 0; }
+    void start() const;
+    void stop() const;
+    [[nodiscard]] uint64_t cycles() const;
+    [[nodiscard]] uint64_t llc_misses() const;
+
+private:
+    int cycles_fd_ = -1;
+    int llc_misses_fd_ = -1;
+};
+
+/**
+ * Hardware counters of a whole OpenMP team, every team thread counts itself and the threads it creates.
+ *
+ * The counters have to be opened by the thread they follow, so they are opened in a parallel region of the same size
+ * as the one used by the kernel (OpenMP reuses the threads of the team between parallel regions). The runtime may give
+ * the region fewer threads than requested, so there is one slot per thread of the team actually created.
+ */
+class TeamPerfCounters {
+public:
+    explicit TeamPerfCounters(int threads);
+
+    [[nodiscard]] bool available() const;
+    void start() const;
+    void stop() const;
+    [[nodiscard]] uint64_t cycles() const;
+    [[nodiscard]] uint64_t llc_misses() const;
+
+private:
+    std::vector<std::unique_ptr<PerfCounters> > counters_;
+};
+
+/**
+ * Structure to hold the result of one benchmark run.
+ */
+struct BenchmarkResult {
+    std::string kernel; ///< Name of the kernel, e.g. "page_rank/delta".
+    int threads = 1; ///< Number of threads used.
+    size_t size = 0; ///< Size of the input (facilities, points or nodes).
+    std::string scaling; ///< Sweep of the run, "strong" (fixed size) or "weak" (work proportional to the threads).
+    double total_ms = 0.0; ///< Wall time of the whole run.
+    std::map<std::string, PhaseStats> phases; ///< Instrumented phases entered during the run.
+    std::map<std::string, uint64_t> counters; ///< Work counters collected during the run.
+    double throughput = 0.0; ///< Units of work per second.
+    std::string throughput_unit; ///< Unit of the throughput, e.g. "edges/s".
+    bool perf_available = false; ///< True if the hardware counters below were measured.
+    uint64_t cycles = 0; ///< CPU cycles of all threads of the run.
+    uint64_t llc_misses = 0; ///< Last level cache misses of all threads of the run.
+};
+
+bool write_benchmark_json(const std::string &filename, const std::vector<BenchmarkResult> &results);
+
+/**
+ * Structure to hold a Single-Row Facility Layout Problem instance.
+ */
+struct SrflpInstance {
+    std::vector<int> faculty_sizes; ///< Size of every faculty.
+    std::vector<std::vector<int> > weights_matrix; ///< Upper triangular matrix of weights between faculties.
+};
+
+// Synthetic inputs for the kernels
+SrflpInstance generate_srflp_instance(size_t faculties, unsigned seed);
+std::vector<std::vector<double> > generate_clustered_points(size_t points, size_t dimensions, size_t clusters,
+                                                            unsigned seed);
+bool write_power_law_graph(const std::string &filename, size_t nodes, size_t average_degree, unsigned seed);
+
+#endif // BENCHMARK_H
@@ -0,0 +1,220 @@
+#include "benchmark.h"
+#include "srflp.h"
+#include "affinity_propagation.h"
+#include "page_rank.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <omp.h>
+
+constexpr unsigned input_seed = 42; ///< Seed of all generated inputs, so every run sees the same data
+constexpr int affinity_max_iteration = 100;
+constexpr size_t graph_average_degree = 8;
+
+/**
+ * Runs one kernel with the given number of threads and collects its phases, counters and throughput.
+ *
+ * The progress output of the kernel is muted, a single summary line is printed instead.
+ *
+ * @param kernel The name of the kernel.
+ * @param threads The number of threads to use.
+ * @param size The size of the input.
+ * @param scaling The sweep the run belongs to, "strong" (fixed size) or "weak" (work proportional to the threads).
+ * @param throughput_unit The unit of the work returned by the body.
+ * @param body The kernel to run, returns the amount of work done (e.g. processed edges).
+ * @return The result of the run.
+ */
+BenchmarkResult run_benchmark(const std::string &kernel,
+                              const int threads,
+                              const size_t size,
+                              const std::string &scaling,
+                              const std::string &throughput_unit,
+                              const std::function<double()> &body) {
+    omp_set_num_threads(threads);
+    const TeamPerfCounters perf(threads);
+    reset_instrumentation();
+
+    std::streambuf *cout_buffer = std::cout.rdbuf(nullptr);
+    perf.start();
+    const std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+    const double work = body();
+    const std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+    perf.stop();
+    std::cout.rdbuf(cout_buffer);
+
+    BenchmarkResult result;
+    result.kernel = kernel;
+    result.threads = threads;
+    result.size = size;
+    result.scaling = scaling;
+    result.total_ms = std::chrono::duration<double, std::milli>(end - begin).count();
+    result.phases = get_phase_stats();
+    result.counters = get_counters();
+    result.throughput = result.total_ms > 0.0 ? work / (result.total_ms / 1000.0) : 0.0;
+    result.throughput_unit = throughput_unit;
+    result.perf_available = perf.available();
+    result.cycles = perf.cycles();
+    result.llc_misses = perf.llc_misses();
+
+    std::cout << kernel << " (" << scaling << "), threads: " << threads << ", size: " << size << ", time: "
+            << result.total_ms << "ms, throughput: " << result.throughput << " " << throughput_unit << std::endl;
+    return result;
+}
+
+/**
+ * Runs the affinity propagation kernel on generated clustered points with all given thread counts.
+ *
+ * @param size The number of points.
+ * @param thread_counts The numbers of threads to use.
+ * @param scaling The sweep the runs belong to.
+ * @param results The results to append to.
+ */
+void benchmark_affinity_propagation(const size_t size,
+                                    const std::vector<int> &thread_counts,
+                                    const std::string &scaling,
+                                    std::vector<BenchmarkResult> &results) {
+    const std::vector<std::vector<double> > points = generate_clustered_points(size, 8, 5, input_seed);
+    for (const int threads: thread_counts) {
+        results.push_back(run_benchmark("affinity_propagation", threads, size, scaling, "steps/s", [&] {
+            const std::vector<std::vector<double> > similarity = calculate_similarity_matrix(points, false);
+            calculate_affinity_propagation(similarity, affinity_max_iteration, false);
+            return static_cast<double>(get_counters()["affinity/steps"]);
+        }));
+    }
+}
+
+/**
+ * Runs the PageRank kernels on a generated power-law graph with all given thread counts.
+ *
+ * @param size The number of nodes of the graph.
+ * @param thread_counts The numbers of threads to use.
+ * @param scaling The sweep the runs belong to.
+ * @param results The results to append to.
+ * @return True if the graph was generated successfully.
+ */
+bool benchmark_page_rank(const size_t size,
+                         const std::vector<int> &thread_counts,
+                         const std::string &scaling,
+                         std::vector<BenchmarkResult> &results) {
+    const std::string graph_filename = (std::filesystem::temp_directory_path() /
+                                        ("power_law_graph_" + std::to_string(size) + ".txt")).string();
+    if (!write_power_law_graph(graph_filename, size, graph_average_degree, input_seed)) {
+        return false;
+    }
+
+    // The graph and its CSR are prepared once per size, the kernels below only read them
+    const long max_threads = *std::max_element(thread_counts.begin(), thread_counts.end());
+    std::streambuf *cout_buffer = std::cout.rdbuf(nullptr);
+    const AdjacencyList graph = load_data(graph_filename, max_threads);
+    const size_t total_nodes = get_total_node_count(graph);
+    const CsrGraph csr = build_csr(graph, compute_vertex_order(graph, total_nodes, "original"));
+    std::cout.rdbuf(cout_buffer);
+
+    for (const int threads: thread_counts) {
+        results.push_back(run_benchmark("page_rank/load", threads, size, scaling, "edges/s", [&] {
+            load_data(graph_filename, threads);
+            return static_cast<double>(csr.in_sources.size());
+        }));
+        results.push_back(run_benchmark("page_rank/pull_csr", threads, size, scaling, "edges/s", [&] {
+            page_rank_csr(csr, DAMPING_FACTOR, EPSILON, MAX_ITERATIONS);
+            return static_cast<double>(get_counters()["page_rank/edges"]);
+        }));
+        results.push_back(run_benchmark("page_rank/delta", threads, size, scaling, "edges/s", [&] {
+            page_rank_delta(csr, DAMPING_FACTOR, DELTA_TOLERANCE_PER_NODE * static_cast<double>(total_nodes),
+                            MAX_DELTA_ITERATIONS);
+            return static_cast<double>(get_counters()["page_rank/edges"]);
+        }));
+        results.push_back(run_benchmark("page_rank/blocked", threads, size, scaling, "edges/s", [&] {
+            page_rank_blocked(csr, BLOCK_PARTITION_BYTES / sizeof(double), DAMPING_FACTOR, EPSILON,
+                              MAX_ITERATIONS);
+            return static_cast<double>(get_counters()["page_rank/edges"]);
+        }));
+    }
+
+    std::remove(graph_filename.c_str());
+    return true;
+}
+
+int main(int argc, char *argv[]) {
+    // Usage: ./run_benchmarks [output_file] [--quick]
+    std::string output_filename = "benchmark_results.json";
+    bool quick = false;
+    for (int i = 1; i < argc; ++i) {
+        if (const std::string arg = argv[i]; arg == "--quick") {
+            quick = true;
+        } else {
+            output_filename = arg;
+        }
+    }
+
+    // Thread counts are powers of two up to the number of hardware threads, which is always included
+    const int max_threads = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+    std::vector<int> thread_counts;
+    for (int threads = 1; threads < max_threads; threads *= 2) {
+        thread_counts.push_back(threads);
+    }
+    thread_counts.push_back(max_threads);
+
+    // Input sizes of the strong scaling sweep, every size is run with all thread counts
+    const std::vector<size_t> srflp_sizes = quick ? std::vector<size_t>{7, 8} : std::vector<size_t>{8, 9, 10};
+    const std::vector<size_t> affinity_sizes = quick
+                                                   ? std::vector<size_t>{50, 100}
+                                                   : std::vector<size_t>{100, 200, 400};
+    const std::vector<size_t> graph_sizes = quick
+                                                ? std::vector<size_t>{10000, 50000}
+                                                : std::vector<size_t>{100000, 500000, 1000000};
+
+    // Input sizes of one thread in the weak scaling sweep, the size of every run is chosen so that its work grows
+    // linearly with the threads. PageRank work is linear in the nodes, so their count is this base times the threads.
+    // An affinity propagation iteration costs O(n^3), so the points are scaled by the cube root of the threads.
+    // SRFLP is left out, its work grows with n! and cannot be scaled linearly with the threads.
+    const size_t affinity_weak_base = quick ? 50 : 100;
+    const size_t graph_weak_base = quick ? 10000 : 100000;
+
+    std::vector<BenchmarkResult> results;
+
+    for (const size_t size: srflp_sizes) {
+        const SrflpInstance instance = generate_srflp_instance(size, input_seed);
+        for (const int threads: thread_counts) {
+            results.push_back(run_benchmark("srflp/branch_and_bound", threads, size, "strong", "permutations/s", [&] {
+                branch_and_bound(instance.faculty_sizes, instance.weights_matrix, threads);
+                return static_cast<double>(get_counters()["srflp/permutations"]);
+            }));
+        }
+    }
+
+    for (const size_t size: affinity_sizes) {
+        benchmark_affinity_propagation(size, thread_counts, "strong", results);
+    }
+    for (const int threads: thread_counts) {
+        const auto size = static_cast<size_t>(std::lround(static_cast<double>(affinity_weak_base) *
+                                                          std::cbrt(static_cast<double>(threads))));
+        benchmark_affinity_propagation(size, {threads}, "weak", results);
+    }
+
+    for (const size_t size: graph_sizes) {
+        if (!benchmark_page_rank(size, thread_counts, "strong", results)) {
+            return 1;
+        }
+    }
+    for (const int threads: thread_counts) {
+        if (!benchmark_page_rank(graph_weak_base * threads, {threads}, "weak", results)) {
+            return 1;
+        }
+    }
+
+    if (!write_benchmark_json(output_filename, results)) {
+        return 1;
+    }
+    std::cout << "Results written to " << output_filename << std::endl;
+
+    return 0;
+}
@@ -1,3 +1,6 @@
+#include "srflp.h"
+#include "benchmark.h"
+
 #include <algorithm>
 #include <iostream>
 #include <vector>
@@ -5,6 +8,7 @@
 #include <fstream>
 #include <sstream>
 #include <thread>
+#include <limits>
 
 /**
  * Load the content of a file into a vector of strings.
@@ -117,9 +121,12 @@ void branch_and_bound_worker(const std::vector<int> &faculties_sizes,
  *
  * @param faculties_sizes A vector representing the size of each faculty.
  * @param weights_matrix A square matrix representing weights between faculties.
+ * @param number_of_threads The number of threads to use.
+ * @return The cost of the best permutation.
  */
-void branch_and_bound(const std::vector<int> &faculties_sizes,
-                      const std::vector<std::vector<int> > &weights_matrix) {
+unsigned long long branch_and_bound(const std::vector<int> &faculties_sizes,
+                                    const std::vector<std::vector<int> > &weights_matrix,
+                                    const size_t number_of_threads = std::thread::hardware_concurrency()) {
     // Initialize the base permutation (0 to n-1)
     std::vector<int> base_permutation(faculties_sizes.size());
     for (std::vector<int>::size_type i = 0; i < base_permutation.size(); ++i) {
@@ -128,17 +135,20 @@ void branch_and_bound(const std::vector<int> &faculties_sizes,
 
     // Generate all permutations
     std::vector<std::vector<int> > all_permutations;
-    all_permutations.push_back(base_permutation);
-    while (std::next_permutation(base_permutation.begin(), base_permutation.end())) {
+    {
+        ScopedPhase phase("srflp/generate");
         all_permutations.push_back(base_permutation);
+        while (std::next_permutation(base_permutation.begin(), base_permutation.end())) {
+            all_permutations.push_back(base_permutation);
+        }
     }
+    add_counter("srflp/permutations", all_permutations.size());
+    ScopedPhase phase("srflp/evaluate");
 
     // Initialize the global best cost
     unsigned long long best_cost = std::numeric_limits<unsigned long long>::max();
     std::vector<int> best_permutation;
 
-    // Determine the number of threads to use based on the hardware concurrency
-    const size_t number_of_threads = std::thread::hardware_concurrency();
     std::cout << "Number of threads: " << number_of_threads << std::endl;
     const size_t total_permutations = all_permutations.size();
     std::cout << "Total permutations: " << total_permutations << std::endl;
@@ -189,10 +199,13 @@ void branch_and_bound(const std::vector<int> &faculties_sizes,
         std::cout << faculty << " ";
     }
     std::cout << std::endl;
+
+    return best_cost;
 }
 
-int main() {
-    const std::string filename = "../project_1/Y-10_t.txt";
+#ifndef BENCHMARK_KERNELS_ONLY
+int main(int argc, char *argv[]) {
+    const std::string filename = argc > 1 ? argv[1] : "../project_1/Y-10_t.txt";
     std::vector<std::string> data = load_file(filename);
 
     if (data.empty()) {
@@ -216,6 +229,8 @@ int main() {
     }
 
     branch_and_bound(faculties_sizes, weights_matrix);
+    print_phase_summary(std::cout);
 
     return 0;
 }
+#endif
@@ -0,0 +1,16 @@
+#ifndef SRFLP_H
+#define SRFLP_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+std::vector<std::string> load_file(const std::string &filename);
+unsigned long long calculate_cost(const std::vector<int> &permutation,
+                                  const std::vector<std::vector<int> > &weights_matrix,
+                                  const std::vector<int> &faculty_sizes);
+unsigned long long branch_and_bound(const std::vector<int> &faculties_sizes,
+                                    const std::vector<std::vector<int> > &weights_matrix,
+                                    size_t number_of_threads);
+
+#endif // SRFLP_H
@@ -1,3 +1,6 @@
+#include "affinity_propagation.h"
+#include "benchmark.h"
+
 #include <fstream>
 #include <iostream>
 #include <sstream>
@@ -79,9 +82,6 @@ void print_matrix(const std::vector<std::vector<double> > &matrix, const std::st
     std::cout << std::endl;
 }
 
-// forward declaration for better code readability
-void create_clusters(const std::vector<std::vector<double> > &matrix_C);
-
 /**
  * Calculates the similarity matrix for the given data.
  *
@@ -91,6 +91,7 @@ void create_clusters(const std::vector<std::vector<double> > &matrix_C);
  */
 std::vector<std::vector<double> > calculate_similarity_matrix(const std::vector<std::vector<double> > &data,
                                                               const bool verbose) {
+    ScopedPhase phase("affinity/similarity");
     const size_t size_n = data.size(); // dimension of the data, meaning first dimension of the matrix
     const std::vector<double> row(size_n, 0); // initialize a row with zeros, meaning second dimension of the matrix
     std::vector<std::vector<double> > similarity_matrix(size_n, row); // initialize a matrix with zeros
@@ -147,6 +148,9 @@ std::vector<std::vector<double> > calculate_affinity_propagation(const std::vect
     int iteration = 0; // iteration counter
 
     while (changed && iteration < max_iteration) {
+        ScopedPhase phase("affinity/iteration");
+        // Both matrix updates run an inner loop over all n points for every one of the n * n cells
+        add_counter("affinity/steps", 2 * size_n * size_n * size_n);
         std::cout << "Iteration " << iteration << " out of " << max_iteration << std::endl;
         iteration++;
 
@@ -287,12 +291,13 @@ void create_clusters(const std::vector<std::vector<double> > &matrix_C) {
 }
 
 
-int main() {
+#ifndef BENCHMARK_KERNELS_ONLY
+int main(int argc, char *argv[]) {
     constexpr int max_iteration = 100;
 
     // five participants
     bool verbose = true;
-    const std::string five_participant_file = "../project_2/five_participants.csv";
+    const std::string five_participant_file = argc > 1 ? argv[1] : "../project_2/five_participants.csv";
     const std::vector<std::string> five_participant_dataset = read_csv_file(five_participant_file);
     const std::vector<std::vector<double> > five_participant_matrix = tokenize_csv(five_participant_dataset);
     const std::vector<std::vector<double> > five_participants_similarity_matrix = calculate_similarity_matrix(
@@ -312,5 +317,8 @@ int main() {
     //     mnist_test_similarity_matrix, max_iteration, verbose);
     // create_clusters(mnist_test_clusters);
 
+    print_phase_summary(std::cout);
+
     return 0;
 }
+#endif
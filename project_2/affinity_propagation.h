@@ -0,0 +1,17 @@
+#ifndef AFFINITY_PROPAGATION_H
+#define AFFINITY_PROPAGATION_H
+
+#include <string>
+#include <vector>
+
+std::vector<std::string> read_csv_file(const std::string &filename);
+std::vector<std::vector<double> > tokenize_csv(const std::vector<std::string> &data, char delimiter);
+void print_matrix(const std::vector<std::vector<double> > &matrix, const std::string &name);
+std::vector<std::vector<double> > calculate_similarity_matrix(const std::vector<std::vector<double> > &data,
+                                                              bool verbose);
+std::vector<std::vector<double> > calculate_affinity_propagation(const std::vector<std::vector<double> > &matrix_S,
+                                                                 int max_iteration,
+                                                                 bool verbose);
+void create_clusters(const std::vector<std::vector<double> > &matrix_C);
+
+#endif // AFFINITY_PROPAGATION_H
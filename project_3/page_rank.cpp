@@ -1,25 +1,25 @@
+#include "page_rank.h"
+#include "benchmark.h"
+
 #include <fstream>
 #include <iostream>
 #include <thread>
 #include <vector>
 #include <string>
-#include <unordered_map>
 #include <sstream>
 #include <chrono>
 #include <cmath>
 #include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <initializer_list>
+#include <memory>
+#include <stdexcept>
+#include <omp.h>
 
-#define DAMPING_FACTOR 0.85
-#define EPSILON 1e-6
-#define MAX_ITERATIONS 100
-
-/**
- * Structure to hold the adjacency list representation of the graph.
- */
-struct AdjacencyList {
-    std::unordered_map<int, std::vector<int> > n_minus; ///< Map of nodes to their incoming neighbors.
-    std::unordered_map<int, std::vector<int> > n_plus; ///< Map of nodes to their outgoing neighbors.
-};
+#ifdef PAGE_RANK_MPI
+#include <mpi.h>
+#endif
 
 /**
  * Worker function to load a portion of the graph data from a file.
@@ -63,9 +63,13 @@ void load_data_worker(const std::string &filename,
  * Function to load the entire graph data from a file using multiple threads.
  *
  * @param filename The name of the file to read from.
+ * @param num_threads The number of threads to use.
  * @return The adjacency list representing the graph.
  */
-AdjacencyList load_data(const std::string &filename) {
+AdjacencyList load_data(const std::string &filename,
+                        const long num_threads = static_cast<long>(std::thread::hardware_concurrency())) {
+    ScopedPhase phase("page_rank/load");
+
     std::ifstream file(filename, std::ios::ate | std::ios::binary);
     if (!file.is_open()) {
         std::cerr << "Error opening file: " << filename << std::endl;
@@ -76,8 +80,7 @@ AdjacencyList load_data(const std::string &filename) {
     std::streampos file_size = file.tellg();
     file.seekg(0); // Move the cursor back to the beginning
 
-    // Determine the number of threads to use and the chunk size for each thread
-    const long num_threads = std::thread::hardware_concurrency();
+    // Determine the chunk size for each thread
     const long chunk_size = file_size / num_threads;
     std::vector<std::streampos> chunk_boundaries;
     chunk_boundaries.reserve(num_threads + 1);
@@ -145,6 +148,21 @@ size_t get_total_node_count(const AdjacencyList &all_vertices) {
     return all_vertices_map.size();
 }
 
+/**
+ * Function to print the number of edges processed by a PageRank run, also as the number of passes over all edges.
+ *
+ * A pull iteration reads every edge once, so for the pull modes the number of passes equals the number of iterations.
+ * For the push modes it makes the saving of the frontier directly comparable with them.
+ *
+ * @param edges_processed The number of edges read or pushed by the run.
+ * @param total_edges The number of edges of the graph.
+ */
+void print_edges_processed(const size_t edges_processed, const size_t total_edges) {
+    std::cout << "Edges processed: " << edges_processed << " ("
+            << (total_edges > 0 ? static_cast<double>(edges_processed) / static_cast<double>(total_edges) : 0.0)
+            << " passes over " << total_edges << " edges)" << std::endl;
+}
+
 /**
  * Worker function to compute a portion of the PageRank values.
  *
@@ -205,8 +223,15 @@ std::vector<double> page_rank(const AdjacencyList &graph,
     std::vector<double> page_rank(total_nodes, 1.0 / static_cast<double>(total_nodes));
     // Create a new vector to store the updated PageRank values
     std::vector<double> new_page_rank(total_nodes, 0.0);
+    // Every iteration reads all incoming edges
+    size_t total_edges = 0;
+    for (const auto &[target, sources]: graph.n_plus) {
+        total_edges += sources.size();
+    }
+    size_t edges_processed = 0;
 
     for (int iteration = 0; iteration < max_iterations; ++iteration) {
+        ScopedPhase phase("page_rank/iteration");
         std::cout << "Iteration " << iteration + 1 << std::endl;
         double max_change = 0.0; // Track the maximum change in PageRank values for convergence
         std::vector<std::thread> threads;
@@ -226,63 +251,1761 @@ std::vector<double> page_rank(const AdjacencyList &graph,
             thread.join();
         }
         page_rank.swap(new_page_rank); // Swap the old and new PageRank values
+        add_counter("page_rank/edges", total_edges);
+        edges_processed += total_edges;
 
         if (max_change < threshold) {
             std::cout << "Converged in " << iteration + 1 << " iterations." << std::endl;
             break;
         }
     }
+    print_edges_processed(edges_processed, total_edges);
 
     return page_rank;
 }
 
 /**
- * Function to print the top N nodes with the highest PageRank values.
+ * Function to evaluate the residuals r(u) = (1 - d) / |V| + d * sum(PR(v) / |N+(v)|) - PR(u) of the given vertices.
+ *
+ * The residual of a vertex is exactly the change a pull iteration would make to its PageRank.
+ *
+ * @param csr The CSR representation of the graph.
+ * @param page_rank The current PageRank values.
+ * @param vertices The vertices whose residuals are evaluated.
+ * @param residual The residuals of all vertices, only the given vertices are overwritten.
+ * @param damping_factor The damping factor used in the PageRank calculation.
+ * @return The number of edges read.
+ */
+size_t compute_residuals(const CsrGraph &csr,
+                         const std::vector<double> &page_rank,
+                         const std::vector<int> &vertices,
+                         std::vector<double> &residual,
+                         const double damping_factor) {
+    const double teleport = (1.0 - damping_factor) / static_cast<double>(csr.node_count());
+    const long vertex_count = static_cast<long>(vertices.size());
+    size_t edges_read = 0;
+
+#pragma omp parallel for schedule(dynamic, 1024) default(none) shared(csr, page_rank, vertices, residual, \
+    vertex_count, teleport, damping_factor) reduction(+: edges_read)
+    for (long i = 0; i < vertex_count; ++i) {
+        const int vertex = vertices[i];
+        double rank_sum = 0.0;
+        for (size_t e = csr.in_offsets[vertex]; e < csr.in_offsets[vertex + 1]; ++e) {
+            const int source = csr.in_sources[e];
+            rank_sum += page_rank[source] / static_cast<double>(csr.out_degree(source));
+        }
+        residual[vertex] = teleport + damping_factor * rank_sum - page_rank[vertex];
+        edges_read += csr.in_offsets[vertex + 1] - csr.in_offsets[vertex];
+    }
+
+    add_counter("page_rank/edges", edges_read);
+    return edges_read;
+}
+
+/**
+ * Function to propagate the residuals until the remaining residual mass guarantees the requested accuracy.
+ *
+ * Every vertex keeps a residual, i.e. the part of its PageRank that has not been propagated to its out-neighbours yet.
+ * In each iteration only the active vertices are processed: their residual is added to their PageRank and its damped
+ * share is passed to all out-neighbours. A vertex is active while its residual (in absolute value, residuals may be
+ * negative after graph updates) is above the threshold times its out-degree plus one, so the vertices whose push
+ * retires the most residual per edge go first.
+ *
+ * Folding the residuals r into the PageRank values leaves an L1 error of at most d / (1 - d) * |r|_1. Without active
+ * vertices |r|_1 is at most the threshold times |E| + |V|, so the threshold is derived from the tolerance and the run
+ * stops as soon as no vertex is active.
+ *
+ * The iterations switch direction by the number of outgoing edges of the active vertices. While they make up more than
+ * DELTA_PULL_FRACTION of the graph, the iteration is dense: all vertices are scanned and the new residuals are gathered
+ * over the incoming edges, which costs about the same as a pull iteration and needs no atomics. Below it the active
+ * vertices are kept in a frontier and push along their out-edges with atomic adds, so late iterations touch only a
+ * small part of the graph.
+ *
+ * @param csr The CSR representation of the graph.
+ * @param page_rank The PageRank values, updated in place.
+ * @param residual The residuals of all vertices, updated in place and zero at the end.
+ * @param damping_factor The damping factor used in the PageRank calculation.
+ * @param tolerance The bound on the L1 error of the result.
+ * @param max_iterations The maximum number of iterations.
+ * @return The number of edges read or pushed.
+ */
+size_t propagate_residuals(const CsrGraph &csr,
+                           std::vector<double> &page_rank,
+                           std::vector<double> &residual,
+                           const double damping_factor,
+                           const double tolerance,
+                           const int max_iterations) {
+    const long total_nodes = static_cast<long>(csr.node_count());
+    const size_t total_edges = csr.out_targets.size();
+    const double residual_tolerance = tolerance * (1.0 - damping_factor) / damping_factor;
+    const double threshold = residual_tolerance / static_cast<double>(csr.node_count() + total_edges);
+
+    std::vector<double> contribution(total_nodes, 0.0); // Damped share of the taken residual per outgoing edge
+    std::vector<double> delta(total_nodes, 0.0); // Residuals taken by the frontier, zero for all other vertices
+    std::vector<char> queued(total_nodes, 0); // Flag to add every vertex to the next frontier only once
+    std::vector<int> frontier; // Active vertices, only kept between push iterations
+    bool frontier_valid = false;
+
+    size_t active_vertices = 0;
+    size_t active_edges = 0;
+#pragma omp parallel for default(none) shared(csr, residual, total_nodes, threshold) \
+    reduction(+: active_vertices, active_edges)
+    for (long i = 0; i < total_nodes; ++i) {
+        const size_t degree = csr.out_degree(static_cast<int>(i));
+        if (std::fabs(residual[i]) > threshold * static_cast<double>(degree + 1)) {
+            ++active_vertices;
+            active_edges += degree;
+        }
+    }
+
+    size_t total_edges_processed = 0;
+    int iteration = 0;
+    for (; iteration < max_iterations && active_vertices > 0; ++iteration) {
+        ScopedPhase phase("page_rank/iteration");
+        const bool pull = static_cast<double>(active_edges) > DELTA_PULL_FRACTION * static_cast<double>(total_edges);
+        std::cout << "Iteration " << iteration + 1 << " (" << (pull ? "pull" : "push") << "), active vertices: "
+                << active_vertices << std::endl;
+
+        size_t next_active_vertices = 0;
+        size_t next_active_edges = 0;
+        if (pull) {
+#pragma omp parallel default(none) shared(csr, page_rank, residual, contribution, total_nodes, damping_factor, \
+    threshold) reduction(+: next_active_vertices, next_active_edges)
+            {
+                // Take the residuals of the active vertices before passing them on, so every vertex is updated by a
+                // single thread and neither the residuals nor the counts need atomics
+#pragma omp for
+                for (long i = 0; i < total_nodes; ++i) {
+                    const size_t degree = csr.out_degree(static_cast<int>(i));
+                    const double taken = std::fabs(residual[i]) > threshold * static_cast<double>(degree + 1) ?
+                                             residual[i] : 0.0;
+                    page_rank[i] += taken;
+                    residual[i] -= taken;
+                    contribution[i] = degree > 0 ? damping_factor * taken / static_cast<double>(degree) : 0.0;
+                }
+
+#pragma omp for schedule(dynamic, 1024)
+                for (long i = 0; i < total_nodes; ++i) {
+                    double rank_sum = 0.0;
+                    for (size_t e = csr.in_offsets[i]; e < csr.in_offsets[i + 1]; ++e) {
+                        rank_sum += contribution[csr.in_sources[e]];
+                    }
+                    residual[i] += rank_sum;
+                    const size_t degree = csr.out_degree(static_cast<int>(i));
+                    if (std::fabs(residual[i]) > threshold * static_cast<double>(degree + 1)) {
+                        ++next_active_vertices;
+                        next_active_edges += degree;
+                    }
+                }
+            }
+            frontier_valid = false;
+            total_edges_processed += total_edges;
+            add_counter("page_rank/edges", total_edges);
+        } else {
+            if (!frontier_valid) {
+                frontier.clear();
+                for (long i = 0; i < total_nodes; ++i) {
+                    const size_t degree = csr.out_degree(static_cast<int>(i));
+                    queued[i] = std::fabs(residual[i]) > threshold * static_cast<double>(degree + 1);
+                    if (queued[i]) {
+                        frontier.push_back(static_cast<int>(i));
+                    }
+                }
+            }
+            const long frontier_size = static_cast<long>(frontier.size());
+
+            // Take the residuals of the frontier before passing them on, new residuals land in the next iteration
+#pragma omp parallel for default(none) shared(frontier, frontier_size, page_rank, residual, delta, queued)
+            for (long i = 0; i < frontier_size; ++i) {
+                const int vertex = frontier[i];
+                queued[vertex] = 0;
+                delta[vertex] = residual[vertex];
+                residual[vertex] = 0.0;
+                page_rank[vertex] += delta[vertex];
+            }
+
+            std::vector<int> next_frontier;
+#pragma omp parallel default(none) shared(csr, frontier, frontier_size, residual, delta, queued, next_frontier, \
+    damping_factor, threshold) reduction(+: next_active_edges)
+            {
+                std::vector<int> local_frontier;
+
+#pragma omp for schedule(dynamic, 64)
+                for (long i = 0; i < frontier_size; ++i) {
+                    const int vertex = frontier[i];
+                    const size_t degree = csr.out_degree(vertex);
+                    if (degree == 0) {
+                        continue; // Dangling vertex, nothing to push
+                    }
+
+                    const double vertex_contribution = damping_factor * delta[vertex] / static_cast<double>(degree);
+                    for (size_t e = csr.out_offsets[vertex]; e < csr.out_offsets[vertex + 1]; ++e) {
+                        const int neighbor = csr.out_targets[e];
+                        double new_residual;
+#pragma omp atomic capture
+                        new_residual = residual[neighbor] += vertex_contribution;
+
+                        const size_t neighbor_degree = csr.out_degree(neighbor);
+                        if (std::fabs(new_residual) > threshold * static_cast<double>(neighbor_degree + 1)) {
+                            char was_queued;
+#pragma omp atomic capture
+                            {
+                                was_queued = queued[neighbor];
+                                queued[neighbor] = 1;
+                            }
+                            if (!was_queued) {
+                                local_frontier.push_back(neighbor);
+                                next_active_edges += neighbor_degree;
+                            }
+                        }
+                    }
+                }
+
+#pragma omp critical
+                next_frontier.insert(next_frontier.end(), local_frontier.begin(), local_frontier.end());
+            }
+
+#pragma omp parallel for default(none) shared(frontier, frontier_size, delta)
+            for (long i = 0; i < frontier_size; ++i) {
+                delta[frontier[i]] = 0.0;
+            }
+            total_edges_processed += active_edges;
+            add_counter("page_rank/edges", active_edges);
+
+            frontier.swap(next_frontier);
+            frontier_valid = true;
+            next_active_vertices = frontier.size();
+        }
+        active_vertices = next_active_vertices;
+        active_edges = next_active_edges;
+    }
+
+    if (active_vertices == 0) {
+        std::cout << "Converged in " << iteration << " iterations." << std::endl;
+    }
+
+    // Fold the remaining (sub-threshold) residuals in, they are part of the PageRank mass as well
+    for (long i = 0; i < total_nodes; ++i) {
+        page_rank[i] += residual[i];
+        residual[i] = 0.0;
+    }
+
+    return total_edges_processed;
+}
+
+/**
+ * Function to compute the PageRank values using the push-based delta (residual) approach.
+ *
+ * The run starts from the same uniform PageRank as page_rank(), so the initial residuals are the changes of the first
+ * pull iteration, and they are then propagated by propagate_residuals().
+ *
+ * @param csr The CSR representation of the graph.
+ * @param damping_factor The damping factor used in the PageRank calculation.
+ * @param tolerance The bound on the L1 error of the result, defaults to DELTA_TOLERANCE_PER_NODE * total_nodes.
+ * @param max_iterations The maximum number of iterations.
+ * @return The PageRank values for each vertex of the CSR graph.
+ */
+std::vector<double> page_rank_delta(const CsrGraph &csr,
+                                    const double damping_factor = DAMPING_FACTOR,
+                                    double tolerance = -1.0,
+                                    const int max_iterations = MAX_DELTA_ITERATIONS) {
+    const size_t total_nodes = csr.node_count();
+    if (tolerance < 0.0) {
+        tolerance = DELTA_TOLERANCE_PER_NODE * static_cast<double>(total_nodes);
+    }
+
+    const long node_count = static_cast<long>(total_nodes);
+    const double initial_rank = 1.0 / static_cast<double>(total_nodes);
+    const double teleport = (1.0 - damping_factor) / static_cast<double>(total_nodes);
+    std::vector<double> page_rank(total_nodes, initial_rank);
+    std::vector<double> residual(total_nodes, 0.0);
+    std::vector<double> contribution(total_nodes, 0.0); // PR(v) / |N+(v)|, so every edge costs a single load
+
+    // All vertices start with the same PageRank, so their residuals are gathered like in page_rank_csr()
+#pragma omp parallel default(none) shared(csr, residual, contribution, node_count, initial_rank, teleport, \
+    damping_factor)
+    {
+#pragma omp for
+        for (long i = 0; i < node_count; ++i) {
+            const size_t degree = csr.out_degree(static_cast<int>(i));
+            contribution[i] = degree > 0 ? initial_rank / static_cast<double>(degree) : 0.0;
+        }
+
+#pragma omp for schedule(dynamic, 1024)
+        for (long i = 0; i < node_count; ++i) {
+            double rank_sum = 0.0;
+            for (size_t e = csr.in_offsets[i]; e < csr.in_offsets[i + 1]; ++e) {
+                rank_sum += contribution[csr.in_sources[e]];
+            }
+            residual[i] = teleport + damping_factor * rank_sum - initial_rank;
+        }
+    }
+    add_counter("page_rank/edges", csr.in_sources.size());
+
+    const size_t edges_processed = csr.in_sources.size() +
+                                   propagate_residuals(csr, page_rank, residual, damping_factor, tolerance,
+                                                       max_iterations);
+    print_edges_processed(edges_processed, csr.out_targets.size());
+
+    return page_rank;
+}
+
+/**
+ * Function to load a batch of edge updates from a file.
+ *
+ * Each line contains the operation ('+' for insertion, '-' for removal) followed by the source and target node,
+ * e.g. "+ 1 2". Empty lines and lines starting with '#' are skipped.
+ *
+ * @param filename The name of the file to read from.
+ * @return The edge updates in the order of the file.
+ */
+std::vector<EdgeUpdate> load_edge_updates(const std::string &filename) {
+    std::vector<EdgeUpdate> updates;
+    std::ifstream file(filename);
+    if (!file.is_open()) {
+        std::cerr << "Error opening file: " << filename << std::endl;
+        return updates;
+    }
+
+    std::string line;
+    while (std::getline(file, line)) {
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+
+        char operation;
+        EdgeUpdate update{};
+        std::istringstream iss(line);
+        if (!(iss >> operation >> update.source >> update.target) || (operation != '+' && operation != '-')) {
+            std::cerr << "Skipping malformed edge update: " << line << std::endl;
+            continue;
+        }
+        update.insert = operation == '+';
+        updates.push_back(update);
+    }
+
+    file.close();
+    return updates;
+}
+
+/**
+ * Function to apply a batch of edge updates to the graph.
+ *
+ * @param graph The adjacency list representing the graph, updated in place.
+ * @param updates The edge insertions and removals to apply.
+ * @return The vertices whose incoming PageRank contributions changed, i.e. all old and new out-neighbours of every
+ *         source with a changed out-degree.
+ */
+std::vector<int> apply_edge_updates(AdjacencyList &graph, const std::vector<EdgeUpdate> &updates) {
+    std::unordered_map<int, std::vector<int> > removed_targets; // Removed out-neighbours of every changed source
+
+    for (const auto &[source, target, insert]: updates) {
+        if (insert) {
+            graph.n_minus[source].push_back(target);
+            graph.n_plus[target].push_back(source);
+            removed_targets[source]; // Mark the source as changed
+            continue;
+        }
+
+        // Remove a single occurrence of the edge, erase empty lists so dangling vertices stay detectable
+        auto out_it = graph.n_minus.find(source);
+        if (out_it == graph.n_minus.end()) {
+            continue;
+        }
+        auto &targets = out_it->second;
+        auto target_it = std::find(targets.begin(), targets.end(), target);
+        if (target_it == targets.end()) {
+            continue;
+        }
+        targets.erase(target_it);
+        if (targets.empty()) {
+            graph.n_minus.erase(out_it);
+        }
+
+        auto &sources = graph.n_plus[target];
+        sources.erase(std::find(sources.begin(), sources.end(), source));
+        if (sources.empty()) {
+            graph.n_plus.erase(target);
+        }
+        removed_targets[source].push_back(target);
+    }
+
+    // Every out-neighbour of a changed source gets a different contribution, because its out-degree changed
+    std::vector<int> affected;
+    for (const auto &[source, targets]: removed_targets) {
+        affected.insert(affected.end(), targets.begin(), targets.end());
+        if (auto it = graph.n_minus.find(source); it != graph.n_minus.end()) {
+            affected.insert(affected.end(), it->second.begin(), it->second.end());
+        }
+    }
+    std::sort(affected.begin(), affected.end());
+    affected.erase(std::unique(affected.begin(), affected.end()), affected.end());
+
+    return affected;
+}
+
+/**
+ * Function to save the PageRank values to a binary file (node count followed by the raw values).
  *
+ * @param filename The name of the file to write to.
  * @param page_rank The PageRank values for each node.
- * @param top_n The number of top nodes to print.
+ * @return True if the values were written successfully.
  */
-void print_top_n_nodes(const std::vector<double> &page_rank,
-                       const size_t top_n = 10) {
-    std::vector<std::pair<int, double> > node_ranks;
-    // Pair each node with its PageRank value
-    for (size_t i = 0; i < page_rank.size(); ++i) {
-        node_ranks.emplace_back(static_cast<int>(i), page_rank[i]);
+bool save_page_rank(const std::string &filename, const std::vector<double> &page_rank) {
+    std::ofstream file(filename, std::ios::binary);
+    if (!file.is_open()) {
+        std::cerr << "Error opening file: " << filename << std::endl;
+        return false;
     }
 
-    // Sort nodes by PageRank value in descending order
-    std::sort(node_ranks.begin(), node_ranks.end(), [](const auto &a, const auto &b) {
-        return b.second < a.second;
-    });
+    const uint64_t count = page_rank.size();
+    file.write(reinterpret_cast<const char *>(&count), sizeof(count));
+    file.write(reinterpret_cast<const char *>(page_rank.data()),
+               static_cast<std::streamsize>(page_rank.size() * sizeof(double)));
 
-    std::cout << "Top " << top_n << " nodes with highest PageRank:" << std::endl;
+    return file.good();
+}
 
-    // Print the top N nodes with the highest PageRank values
-    for (size_t i = 0; i < top_n && i < node_ranks.size(); ++i) {
-        std::cout << "Node " << node_ranks[i].first << ": " << node_ranks[i].second << std::endl;
+/**
+ * Function to load PageRank values saved by save_page_rank().
+ *
+ * @param filename The name of the file to read from.
+ * @return The PageRank values for each node, empty if the file cannot be read.
+ */
+std::vector<double> load_page_rank(const std::string &filename) {
+    std::ifstream file(filename, std::ios::binary);
+    if (!file.is_open()) {
+        return {};
+    }
+
+    uint64_t count = 0;
+    file.read(reinterpret_cast<char *>(&count), sizeof(count));
+    std::vector<double> page_rank(count);
+    file.read(reinterpret_cast<char *>(page_rank.data()), static_cast<std::streamsize>(count * sizeof(double)));
+    if (!file) {
+        std::cerr << "Error reading PageRank values from: " << filename << std::endl;
+        return {};
+    }
+
+    return page_rank;
+}
+
+/**
+ * Function to re-converge PageRank after the graph has changed, starting from the previous PageRank values.
+ *
+ * The previous values are rescaled to the new node count (the teleport term scales linearly with 1 / |V|), then the
+ * residuals are evaluated only for the affected vertices and vertices that did not exist before. All other vertices
+ * already satisfy the equation, so only the changes are propagated by propagate_residuals().
+ *
+ * @param csr The CSR representation of the updated graph, in the original order.
+ * @param previous_page_rank The converged PageRank values before the update.
+ * @param affected The vertices whose incoming contributions changed, as returned by apply_edge_updates().
+ * @param damping_factor The damping factor used in the PageRank calculation.
+ * @param tolerance The bound on the L1 error of the result, defaults to DELTA_TOLERANCE_PER_NODE * total_nodes.
+ * @param max_iterations The maximum number of iterations.
+ * @return The PageRank values for each node of the updated graph.
+ */
+std::vector<double> page_rank_incremental(const CsrGraph &csr,
+                                          const std::vector<double> &previous_page_rank,
+                                          std::vector<int> affected,
+                                          const double damping_factor = DAMPING_FACTOR,
+                                          double tolerance = -1.0,
+                                          const int max_iterations = MAX_DELTA_ITERATIONS) {
+    const size_t total_nodes = csr.node_count();
+    if (tolerance < 0.0) {
+        tolerance = DELTA_TOLERANCE_PER_NODE * static_cast<double>(total_nodes);
     }
+    const size_t previous_nodes = previous_page_rank.size();
+    const double scale = static_cast<double>(previous_nodes) / static_cast<double>(total_nodes);
+    std::vector<double> page_rank(total_nodes, 0.0);
+    for (size_t i = 0; i < std::min(previous_nodes, total_nodes); ++i) {
+        page_rank[i] = previous_page_rank[i] * scale;
+    }
+
+    // Vertices that did not exist before start with zero PageRank, so their residual has to be evaluated as well
+    for (size_t i = previous_nodes; i < total_nodes; ++i) {
+        affected.push_back(static_cast<int>(i));
+    }
+    affected.erase(std::remove_if(affected.begin(), affected.end(), [total_nodes](const int vertex) {
+        return vertex < 0 || static_cast<size_t>(vertex) >= total_nodes;
+    }), affected.end());
+    std::sort(affected.begin(), affected.end());
+    affected.erase(std::unique(affected.begin(), affected.end()), affected.end());
+
+    std::vector<double> residual(total_nodes, 0.0);
+    size_t edges_processed = compute_residuals(csr, page_rank, affected, residual, damping_factor);
+
+    std::cout << "Affected vertices: " << affected.size() << std::endl;
+
+    edges_processed += propagate_residuals(csr, page_rank, residual, damping_factor, tolerance, max_iterations);
+    print_edges_processed(edges_processed, csr.out_targets.size());
+
+    return page_rank;
 }
 
+/**
+ * Function to compute a cache-friendly order of the vertices.
+ *
+ * Supported orders are "original" (identity), "degree" (vertices sorted by total degree in descending order, so the
+ * hubs that are read by most of the gathers sit next to each other), "bfs" (breadth-first traversal of the undirected
+ * graph starting from the hubs, so linked vertices get close IDs) and "rcm" (reverse Cuthill-McKee, breadth-first
+ * traversal from low-degree vertices with neighbours visited by increasing degree, reversed at the end).
+ *
+ * @param graph The adjacency list representing the graph.
+ * @param total_nodes The total number of nodes in the graph.
+ * @param order_name The name of the order.
+ * @return The original node IDs in the new order, empty for an unknown order.
+ */
+std::vector<int> compute_vertex_order(const AdjacencyList &graph,
+                                      const size_t total_nodes,
+                                      const std::string &order_name) {
+    std::vector<int> order(total_nodes);
+    for (size_t i = 0; i < total_nodes; ++i) {
+        order[i] = static_cast<int>(i);
+    }
+    if (order_name == "original") {
+        return order;
+    }
+
+    // Total (undirected) degree of every vertex
+    std::vector<size_t> degree(total_nodes, 0);
+    for (const auto *edges: {&graph.n_minus, &graph.n_plus}) {
+        for (const auto &[key, values]: *edges) {
+            if (static_cast<size_t>(key) < total_nodes) {
+                degree[key] += values.size();
+            }
+        }
+    }
 
-int main() {
-    const std::string filename = "../project_3/web-BerkStan.txt";
+    if (order_name == "degree") {
+        std::stable_sort(order.begin(), order.end(), [&degree](const int a, const int b) {
+            return degree[a] > degree[b];
+        });
+        return order;
+    }
 
-    const std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
-    const AdjacencyList all_vertices = load_data(filename);
-    const std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+    if (order_name != "bfs" && order_name != "rcm") {
+        std::cerr << "Unknown vertex order: " << order_name << std::endl;
+        return {};
+    }
 
-    std::cout << "Time for loading data: " << std::chrono::duration_cast<std::chrono::milliseconds>(end - begin).count()
-            << "ms" << std::endl;
-    const size_t total_node_count = get_total_node_count(all_vertices);
-    std::cout << "Total number of nodes: " << total_node_count << std::endl;
+    // BFS starts every component from the biggest hub, Cuthill-McKee from the vertex with the smallest degree
+    const bool cuthill_mckee = order_name == "rcm";
+    std::vector<int> start_candidates = order;
+    std::stable_sort(start_candidates.begin(), start_candidates.end(),
+                     [&degree, cuthill_mckee](const int a, const int b) {
+                         return cuthill_mckee ? degree[a] < degree[b] : degree[a] > degree[b];
+                     });
 
-    const std::chrono::steady_clock::time_point begin_page_rank = std::chrono::steady_clock::now();
-    std::vector<double> page_rank_values = page_rank(all_vertices, total_node_count);
-    const std::chrono::steady_clock::time_point end_page_rank = std::chrono::steady_clock::now();
-    std::cout << "Time for PageRank: " << std::chrono::duration_cast<std::chrono::milliseconds>(
-        end_page_rank - begin_page_rank).count() << "ms" << std::endl;
+    std::vector<char> visited(total_nodes, 0);
+    std::vector<int> neighbors;
+    order.clear();
+    for (const int start: start_candidates) {
+        if (visited[start]) {
+            continue;
+        }
+        visited[start] = 1;
+        size_t head = order.size();
+        order.push_back(start);
+
+        while (head < order.size()) {
+            const int vertex = order[head++];
+
+            neighbors.clear();
+            for (const auto *edges: {&graph.n_minus, &graph.n_plus}) {
+                if (auto it = edges->find(vertex); it != edges->end()) {
+                    for (const int neighbor: it->second) {
+                        if (static_cast<size_t>(neighbor) < total_nodes && !visited[neighbor]) {
+                            visited[neighbor] = 1;
+                            neighbors.push_back(neighbor);
+                        }
+                    }
+                }
+            }
+            if (cuthill_mckee) {
+                std::stable_sort(neighbors.begin(), neighbors.end(), [&degree](const int a, const int b) {
+                    return degree[a] < degree[b];
+                });
+            }
+            order.insert(order.end(), neighbors.begin(), neighbors.end());
+        }
+    }
+
+    if (cuthill_mckee) {
+        std::reverse(order.begin(), order.end());
+    }
+    return order;
+}
+
+/**
+ * Function to build the CSR representation of the graph with the vertices relabelled by the given order.
+ *
+ * @param graph The adjacency list representing the graph.
+ * @param order The original node IDs in the new order, as returned by compute_vertex_order().
+ * @return The CSR representation of the relabelled graph.
+ */
+CsrGraph build_csr(const AdjacencyList &graph, const std::vector<int> &order) {
+    ScopedPhase phase("page_rank/build_csr");
+    const size_t total_nodes = order.size();
+    CsrGraph csr;
+    csr.original_ids = order;
+
+    std::vector<int> new_ids(total_nodes);
+    for (size_t i = 0; i < total_nodes; ++i) {
+        new_ids[order[i]] = static_cast<int>(i);
+    }
+
+    // Builds the offsets and the relabelled (sorted) neighbour lists of one direction of the edges
+    const auto build_direction = [&](const std::unordered_map<int, std::vector<int> > &edges,
+                                     std::vector<size_t> &offsets,
+                                     std::vector<int> &neighbors) {
+        offsets.assign(total_nodes + 1, 0);
+        for (size_t i = 0; i < total_nodes; ++i) {
+            size_t count = 0;
+            if (auto it = edges.find(order[i]); it != edges.end()) {
+                for (const int neighbor: it->second) {
+                    count += static_cast<size_t>(neighbor) < total_nodes;
+                }
+            }
+            offsets[i + 1] = offsets[i] + count;
+        }
+
+        neighbors.resize(offsets[total_nodes]);
+#pragma omp parallel for default(none) shared(edges, offsets, neighbors, order, new_ids, total_nodes)
+        for (long i = 0; i < static_cast<long>(total_nodes); ++i) {
+            size_t position = offsets[i];
+            if (auto it = edges.find(order[i]); it != edges.end()) {
+                for (const int neighbor: it->second) {
+                    if (static_cast<size_t>(neighbor) < total_nodes) {
+                        neighbors[position++] = new_ids[neighbor];
+                    }
+                }
+            }
+            // Sorted neighbours make the gathers walk through the rank vector in increasing order
+            std::sort(neighbors.begin() + static_cast<long>(offsets[i]),
+                      neighbors.begin() + static_cast<long>(offsets[i + 1]));
+        }
+    };
+
+    // Incoming edges are stored in n_plus (target -> sources), outgoing ones in n_minus (source -> targets)
+    build_direction(graph.n_plus, csr.in_offsets, csr.in_sources);
+    build_direction(graph.n_minus, csr.out_offsets, csr.out_targets);
+
+    return csr;
+}
+
+/**
+ * Function to compute the average distance between the IDs of linked vertices, a cheap proxy of gather locality.
+ *
+ * @param csr The CSR representation of the graph.
+ * @return The average absolute difference of source and target IDs over all edges.
+ */
+double average_edge_id_gap(const CsrGraph &csr) {
+    double gap_sum = 0.0;
+    const long total_nodes = static_cast<long>(csr.node_count());
+#pragma omp parallel for default(none) shared(csr, total_nodes) reduction(+: gap_sum)
+    for (long i = 0; i < total_nodes; ++i) {
+        for (size_t e = csr.in_offsets[i]; e < csr.in_offsets[i + 1]; ++e) {
+            gap_sum += std::fabs(static_cast<double>(csr.in_sources[e]) - static_cast<double>(i));
+        }
+    }
+    return csr.in_sources.empty() ? 0.0 : gap_sum / static_cast<double>(csr.in_sources.size());
+}
+
+/**
+ * Function to compute the PageRank values on the CSR representation of the graph (pull approach).
+ *
+ * @param csr The CSR representation of the graph.
+ * @param damping_factor The damping factor used in the PageRank calculation.
+ * @param threshold The convergence threshold.
+ * @param max_iterations The maximum number of iterations.
+ * @return The PageRank values for each vertex of the CSR graph (in its order, not the original one).
+ */
+std::vector<double> page_rank_csr(const CsrGraph &csr,
+                                  const double damping_factor = DAMPING_FACTOR,
+                                  const double threshold = EPSILON,
+                                  const int max_iterations = MAX_ITERATIONS) {
+    const long total_nodes = static_cast<long>(csr.node_count());
+    std::vector<double> page_rank(total_nodes, 1.0 / static_cast<double>(total_nodes));
+    std::vector<double> new_page_rank(total_nodes, 0.0);
+    std::vector<double> contribution(total_nodes, 0.0); // PR(v) / |N+(v)|, so every edge costs a single load
+
+    double total_iteration_ms = 0.0;
+    int iteration = 0;
+    while (iteration < max_iterations) {
+        ScopedPhase phase("page_rank/iteration");
+        const std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+        double max_change = 0.0;
+
+#pragma omp parallel default(none) shared(csr, page_rank, new_page_rank, contribution, total_nodes, damping_factor) \
+    reduction(max: max_change)
+        {
+#pragma omp for
+            for (long i = 0; i < total_nodes; ++i) {
+                const size_t degree = csr.out_degree(static_cast<int>(i));
+                contribution[i] = degree > 0 ? page_rank[i] / static_cast<double>(degree) : 0.0;
+            }
+
+#pragma omp for schedule(dynamic, 1024)
+            for (long i = 0; i < total_nodes; ++i) {
+                double rank_sum = 0.0;
+                for (size_t e = csr.in_offsets[i]; e < csr.in_offsets[i + 1]; ++e) {
+                    rank_sum += contribution[csr.in_sources[e]];
+                }
+                new_page_rank[i] = (1.0 - damping_factor) / static_cast<double>(total_nodes) +
+                                   damping_factor * rank_sum;
+                max_change = std::max(max_change, std::fabs(new_page_rank[i] - page_rank[i]));
+            }
+        }
+        page_rank.swap(new_page_rank);
+        add_counter("page_rank/edges", csr.in_sources.size());
+        ++iteration;
+
+        const std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+        const double iteration_ms = std::chrono::duration<double, std::milli>(end - begin).count();
+        total_iteration_ms += iteration_ms;
+        std::cout << "Iteration " << iteration << ": " << iteration_ms << "ms" << std::endl;
+
+        if (max_change < threshold) {
+            std::cout << "Converged in " << iteration << " iterations." << std::endl;
+            break;
+        }
+    }
+    std::cout << "Average time per iteration: " << total_iteration_ms / iteration << "ms" << std::endl;
+    print_edges_processed(static_cast<size_t>(iteration) * csr.in_sources.size(), csr.in_sources.size());
+
+    return page_rank;
+}
+
+/**
+ * Function to compute the PageRank values on the CSR representation of the graph with propagation blocking.
+ *
+ * Every iteration has two phases. In the binning phase the sources are split into fixed chunks with roughly the same
+ * number of outgoing edges, and every chunk appends the PR(v) / |N+(v)| of each outgoing edge to the bin of the
+ * destination partition, which is a sequential (streaming) write. In the accumulation phase the bins of every
+ * partition are summed into the new PageRank values, and because a partition is sized to fit in L2 cache the random
+ * writes stay in cache. The destinations of the bins do not change between iterations, so they are computed once and
+ * only the contributions are rewritten. The chunks are distributed by a worksharing loop, so the result does not
+ * depend on the size of the team OpenMP actually gives.
+ *
+ * @param csr The CSR representation of the graph.
+ * @param partition_size The number of destination vertices per partition.
+ * @param damping_factor The damping factor used in the PageRank calculation.
+ * @param threshold The convergence threshold.
+ * @param max_iterations The maximum number of iterations.
+ * @return The PageRank values for each vertex of the CSR graph (in its order, not the original one).
+ */
+std::vector<double> page_rank_blocked(const CsrGraph &csr,
+                                      size_t partition_size = BLOCK_PARTITION_BYTES / sizeof(double),
+                                      const double damping_factor = DAMPING_FACTOR,
+                                      const double threshold = EPSILON,
+                                      const int max_iterations = MAX_ITERATIONS) {
+    partition_size = std::max<size_t>(partition_size, 1);
+    const long total_nodes = static_cast<long>(csr.node_count());
+    const long num_chunks = omp_get_max_threads();
+    const size_t num_partitions = (static_cast<size_t>(total_nodes) + partition_size - 1) / partition_size;
+    std::cout << "Partitions: " << num_partitions << " x " << partition_size << " vertices, source chunks: "
+            << num_chunks << std::endl;
+
+    // Every chunk is a contiguous range of sources with roughly the same number of outgoing edges
+    std::vector<long> source_boundaries(num_chunks + 1, total_nodes);
+    source_boundaries[0] = 0;
+    for (long c = 1; c < num_chunks; ++c) {
+        const size_t edge_target = csr.out_targets.size() * c / num_chunks;
+        source_boundaries[c] = std::lower_bound(csr.out_offsets.begin(), csr.out_offsets.end(), edge_target) -
+                               csr.out_offsets.begin();
+        source_boundaries[c] = std::clamp(source_boundaries[c], source_boundaries[c - 1], total_nodes);
+    }
+
+    // Bins of chunk c for partition p, destinations are fixed, contributions are rewritten in every iteration
+    std::vector<std::vector<std::vector<int> > > bin_destinations(num_chunks,
+                                                                   std::vector<std::vector<int> >(num_partitions));
+    std::vector<std::vector<std::vector<double> > > bin_contributions(
+        num_chunks, std::vector<std::vector<double> >(num_partitions));
+
+#pragma omp parallel for schedule(static, 1) default(none) shared(csr, source_boundaries, bin_destinations, \
+    bin_contributions, num_chunks, num_partitions, partition_size)
+    for (long c = 0; c < num_chunks; ++c) {
+        for (long v = source_boundaries[c]; v < source_boundaries[c + 1]; ++v) {
+            for (size_t e = csr.out_offsets[v]; e < csr.out_offsets[v + 1]; ++e) {
+                bin_destinations[c][csr.out_targets[e] / partition_size].push_back(csr.out_targets[e]);
+            }
+        }
+        for (size_t p = 0; p < num_partitions; ++p) {
+            bin_contributions[c][p].resize(bin_destinations[c][p].size());
+        }
+    }
+
+    std::vector<double> page_rank(total_nodes, 1.0 / static_cast<double>(total_nodes));
+    std::vector<double> new_page_rank(total_nodes, 0.0);
+    std::vector<size_t> bin_positions(static_cast<size_t>(num_chunks) * num_partitions, 0);
+
+    double total_iteration_ms = 0.0;
+    int iteration = 0;
+    while (iteration < max_iterations) {
+        ScopedPhase phase("page_rank/iteration");
+        const std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+        double max_change = 0.0;
+
+#pragma omp parallel default(none) shared(csr, page_rank, new_page_rank, source_boundaries, bin_destinations, \
+    bin_contributions, bin_positions, num_chunks, num_partitions, partition_size, total_nodes, damping_factor) \
+    reduction(max: max_change)
+        {
+            // Binning phase, contributions of every chunk are appended sequentially to the bins of the chunk
+#pragma omp for schedule(static, 1)
+            for (long c = 0; c < num_chunks; ++c) {
+                size_t *positions = &bin_positions[static_cast<size_t>(c) * num_partitions];
+                std::fill(positions, positions + num_partitions, 0);
+                for (long v = source_boundaries[c]; v < source_boundaries[c + 1]; ++v) {
+                    const size_t degree = csr.out_degree(static_cast<int>(v));
+                    if (degree == 0) {
+                        continue;
+                    }
+                    const double contribution = page_rank[v] / static_cast<double>(degree);
+                    for (size_t e = csr.out_offsets[v]; e < csr.out_offsets[v + 1]; ++e) {
+                        const size_t partition = csr.out_targets[e] / partition_size;
+                        bin_contributions[c][partition][positions[partition]++] = contribution;
+                    }
+                }
+            }
+
+            // Accumulation phase, every partition is summed by a single thread while it stays in cache
+#pragma omp for schedule(dynamic, 1)
+            for (size_t p = 0; p < num_partitions; ++p) {
+                const long first = static_cast<long>(p * partition_size);
+                const long last = std::min(first + static_cast<long>(partition_size), total_nodes);
+                std::fill(new_page_rank.begin() + first, new_page_rank.begin() + last, 0.0);
+
+                for (long c = 0; c < num_chunks; ++c) {
+                    const std::vector<int> &destinations = bin_destinations[c][p];
+                    const std::vector<double> &contributions = bin_contributions[c][p];
+                    for (size_t k = 0; k < destinations.size(); ++k) {
+                        new_page_rank[destinations[k]] += contributions[k];
+                    }
+                }
+
+                for (long i = first; i < last; ++i) {
+                    new_page_rank[i] = (1.0 - damping_factor) / static_cast<double>(total_nodes) +
+                                       damping_factor * new_page_rank[i];
+                    max_change = std::max(max_change, std::fabs(new_page_rank[i] - page_rank[i]));
+                }
+            }
+        }
+        page_rank.swap(new_page_rank);
+        add_counter("page_rank/edges", csr.in_sources.size());
+        ++iteration;
+
+        const std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+        const double iteration_ms = std::chrono::duration<double, std::milli>(end - begin).count();
+        total_iteration_ms += iteration_ms;
+        std::cout << "Iteration " << iteration << ": " << iteration_ms << "ms" << std::endl;
+
+        if (max_change < threshold) {
+            std::cout << "Converged in " << iteration << " iterations." << std::endl;
+            break;
+        }
+    }
+    std::cout << "Average time per iteration: " << total_iteration_ms / iteration << "ms" << std::endl;
+    print_edges_processed(static_cast<size_t>(iteration) * csr.in_sources.size(), csr.in_sources.size());
+
+    return page_rank;
+}
+
+/**
+ * Function to compute the PageRank values on the graph relabelled by a cache-friendly vertex order.
+ *
+ * The same CSR computation is run on the original order first, so the reported per-iteration times and gather
+ * locality can be compared directly. Both runs are timed on their own and measured with the hardware counters of the
+ * whole OpenMP team, their LLC misses per iteration are printed where perf events are available.
+ *
+ * @param graph The adjacency list representing the graph.
+ * @param total_nodes The total number of nodes in the graph.
+ * @param order_name The name of the vertex order, see compute_vertex_order().
+ * @param original_ids Output, the original node ID of every vertex of the returned PageRank values.
+ * @return The PageRank values for each vertex in the new order, empty for an unknown order.
+ */
+std::vector<double> page_rank_reordered(const AdjacencyList &graph,
+                                        const size_t total_nodes,
+                                        const std::string &order_name,
+                                        std::vector<int> &original_ids) {
+    const std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+    const std::vector<int> order = compute_vertex_order(graph, total_nodes, order_name);
+    if (order.empty()) {
+        return {};
+    }
+    const CsrGraph reordered = build_csr(graph, order);
+    const std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+    std::cout << "Time for reordering (" << order_name << "): "
+            << std::chrono::duration_cast<std::chrono::milliseconds>(end - begin).count() << "ms" << std::endl;
+
+    const CsrGraph original = build_csr(graph, compute_vertex_order(graph, total_nodes, "original"));
+    std::cout << "Average edge ID gap (original): " << average_edge_id_gap(original) << std::endl;
+    std::cout << "Average edge ID gap (" << order_name << "): " << average_edge_id_gap(reordered) << std::endl;
+
+    // Runs the CSR computation with the team counters, the iterations are counted by the instrumented phase
+    const auto measured_page_rank_csr = [](const CsrGraph &csr, const std::string &name) {
+        std::cout << "PageRank in the " << name << " order:" << std::endl;
+        const long iterations_before = get_phase_stats()["page_rank/iteration"].count;
+        const TeamPerfCounters perf(omp_get_max_threads());
+        perf.start();
+        const std::chrono::steady_clock::time_point begin_run = std::chrono::steady_clock::now();
+        std::vector<double> page_rank = page_rank_csr(csr);
+        const std::chrono::steady_clock::time_point end_run = std::chrono::steady_clock::now();
+        perf.stop();
+        const long iterations = get_phase_stats()["page_rank/iteration"].count - iterations_before;
+
+        std::cout << "Time for PageRank (" << name << "): "
+                << std::chrono::duration_cast<std::chrono::milliseconds>(end_run - begin_run).count() << "ms"
+                << std::endl;
+        std::cout << "LLC misses per iteration (" << name << "): ";
+        if (perf.available() && iterations > 0) {
+            std::cout << perf.llc_misses() / static_cast<uint64_t>(iterations) << std::endl;
+        } else {
+            std::cout << "not available" << std::endl;
+        }
+        return page_rank;
+    };
+
+    measured_page_rank_csr(original, "original");
+    std::vector<double> page_rank = measured_page_rank_csr(reordered, order_name);
+
+    original_ids = reordered.original_ids;
+    return page_rank;
+}
+
+/**
+ * Function to load seed sets for personalized PageRank from a file, one seed set (node IDs) per line.
+ *
+ * @param filename The name of the file to read from.
+ * @return The seed sets in the order of the file.
+ */
+std::vector<std::vector<int> > load_seed_sets(const std::string &filename) {
+    std::vector<std::vector<int> > seed_sets;
+    std::ifstream file(filename);
+    if (!file.is_open()) {
+        std::cerr << "Error opening file: " << filename << std::endl;
+        return seed_sets;
+    }
+
+    std::string line;
+    while (std::getline(file, line)) {
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+
+        std::vector<int> seeds;
+        std::istringstream iss(line);
+        int seed;
+        while (iss >> seed) {
+            seeds.push_back(seed);
+        }
+        seed_sets.push_back(seeds);
+    }
+
+    file.close();
+    return seed_sets;
+}
+
+/**
+ * Function to compute personalized PageRank for a batch of up to PPR_BATCH_WIDTH seed sets at once.
+ *
+ * The rank vectors are interleaved, so row v holds PR_k(v) of all seed sets k next to each other. Every edge load then
+ * feeds all lanes of the batch and the inner loops over the lanes are vectorized, which amortizes the graph traversal
+ * across the batch. The teleport vector of seed set k is (1 - d) / |S_k| for the seeds and zero elsewhere, so
+ * PR_k(u) = teleport_k(u) + d * sum(PR_k(v) / |N+(v)|). Convergence is tracked for every seed set separately.
+ *
+ * @param csr The CSR representation of the graph.
+ * @param seed_sets The seed sets (original node IDs), at most PPR_BATCH_WIDTH of them.
+ * @param converged_iterations Output, the iteration in which every seed set converged (0 if it did not).
+ * @param damping_factor The damping factor used in the PageRank calculation.
+ * @param threshold The convergence threshold.
+ * @param max_iterations The maximum number of iterations.
+ * @return The interleaved PageRank values, value of seed set k for vertex v is at v * PPR_BATCH_WIDTH + k.
+ */
+std::vector<double> page_rank_personalized_batch(const CsrGraph &csr,
+                                                 const std::vector<std::vector<int> > &seed_sets,
+                                                 std::vector<int> &converged_iterations,
+                                                 const double damping_factor = DAMPING_FACTOR,
+                                                 const double threshold = EPSILON,
+                                                 const int max_iterations = MAX_ITERATIONS) {
+    constexpr int width = PPR_BATCH_WIDTH;
+    const long total_nodes = static_cast<long>(csr.node_count());
+    const int batch_size = std::min(static_cast<int>(seed_sets.size()), width);
+
+    std::vector<int> new_ids(total_nodes, -1);
+    for (long i = 0; i < total_nodes; ++i) {
+        new_ids[csr.original_ids[i]] = static_cast<int>(i);
+    }
+
+    // Unused lanes have no seeds, so they stay zero and converge immediately
+    std::vector<double> teleport(total_nodes * width, 0.0);
+    std::vector<double> page_rank(total_nodes * width, 0.0);
+    for (int k = 0; k < batch_size; ++k) {
+        std::vector<int> seeds;
+        for (const int seed: seed_sets[k]) {
+            if (seed >= 0 && seed < total_nodes) {
+                seeds.push_back(new_ids[seed]);
+            }
+        }
+        for (const int vertex: seeds) {
+            teleport[vertex * width + k] += (1.0 - damping_factor) / static_cast<double>(seeds.size());
+            page_rank[vertex * width + k] += 1.0 / static_cast<double>(seeds.size());
+        }
+    }
+
+    std::vector<double> new_page_rank(total_nodes * width, 0.0);
+    std::vector<double> contribution(total_nodes * width, 0.0);
+    converged_iterations.assign(batch_size, 0);
+
+    int iteration = 0;
+    while (iteration < max_iterations) {
+        ScopedPhase phase("page_rank/iteration");
+        double max_change[width] = {};
+
+#pragma omp parallel default(none) shared(csr, teleport, page_rank, new_page_rank, contribution, max_change, \
+    total_nodes, damping_factor)
+        {
+            double local_max_change[width] = {};
+
+#pragma omp for
+            for (long i = 0; i < total_nodes; ++i) {
+                const size_t degree = csr.out_degree(static_cast<int>(i));
+                const double inverse_degree = degree > 0 ? 1.0 / static_cast<double>(degree) : 0.0;
+#pragma omp simd
+                for (int k = 0; k < width; ++k) {
+                    contribution[i * width + k] = page_rank[i * width + k] * inverse_degree;
+                }
+            }
+
+#pragma omp for schedule(dynamic, 1024)
+            for (long i = 0; i < total_nodes; ++i) {
+                double rank_sum[width] = {};
+                for (size_t e = csr.in_offsets[i]; e < csr.in_offsets[i + 1]; ++e) {
+                    const double *source_row = &contribution[static_cast<size_t>(csr.in_sources[e]) * width];
+#pragma omp simd
+                    for (int k = 0; k < width; ++k) {
+                        rank_sum[k] += source_row[k];
+                    }
+                }
+
+                for (int k = 0; k < width; ++k) {
+                    const size_t index = i * width + k;
+                    new_page_rank[index] = teleport[index] + damping_factor * rank_sum[k];
+                    local_max_change[k] = std::max(local_max_change[k],
+                                                   std::fabs(new_page_rank[index] - page_rank[index]));
+                }
+            }
+
+#pragma omp critical
+            for (int k = 0; k < width; ++k) {
+                max_change[k] = std::max(max_change[k], local_max_change[k]);
+            }
+        }
+        page_rank.swap(new_page_rank);
+        add_counter("page_rank/edges", csr.in_sources.size());
+        ++iteration;
+
+        bool all_converged = true;
+        for (int k = 0; k < batch_size; ++k) {
+            if (converged_iterations[k] == 0 && max_change[k] < threshold) {
+                converged_iterations[k] = iteration;
+            }
+            all_converged = all_converged && converged_iterations[k] != 0;
+        }
+        if (all_converged) {
+            break;
+        }
+    }
+
+    return page_rank;
+}
+
+/**
+ * Buffered writer of exported PageRank records, shared by all exports so no sorted copy of the values is needed.
+ *
+ * The records are written through a fixed-size buffer. The text format has one line per record with its IDs and rank
+ * separated by spaces, the binary format has the record count (uint64) followed by the records (int32 IDs, double).
+ */
+class RankRecordWriter {
+public:
+    RankRecordWriter(const std::string &filename, const bool binary, const uint64_t record_count)
+        : file_(filename, binary ? std::ios::binary : std::ios::out), binary_(binary) {
+        if (!file_.is_open()) {
+            std::cerr << "Error opening file: " << filename << std::endl;
+            return;
+        }
+        buffer_.reserve(buffer_size + 64);
+        if (binary_) {
+            buffer_.append(reinterpret_cast<const char *>(&record_count), sizeof(record_count));
+        }
+    }
+
+    [[nodiscard]] bool is_open() const { return file_.is_open(); }
+
+    /**
+     * Appends one record to the buffer and writes the buffer out once it is full.
+     *
+     * @param ids The IDs of the record (e.g. node, or seed set and node).
+     * @param rank The PageRank value of the record.
+     */
+    void write(const std::initializer_list<int32_t> ids, const double rank) {
+        if (binary_) {
+            for (const int32_t id: ids) {
+                buffer_.append(reinterpret_cast<const char *>(&id), sizeof(id));
+            }
+            buffer_.append(reinterpret_cast<const char *>(&rank), sizeof(rank));
+        } else {
+            char line[64];
+            int length = 0;
+            for (const int32_t id: ids) {
+                length += std::snprintf(line + length, sizeof(line) - length, "%d ", id);
+            }
+            length += std::snprintf(line + length, sizeof(line) - length, "%.10g\n", rank);
+            buffer_.append(line, static_cast<size_t>(length));
+        }
+
+        if (buffer_.size() >= buffer_size) {
+            file_.write(buffer_.data(), static_cast<std::streamsize>(buffer_.size()));
+            buffer_.clear();
+        }
+    }
+
+    /**
+     * Writes out the rest of the buffer.
+     *
+     * @return True if all records were written successfully.
+     */
+    bool finish() {
+        file_.write(buffer_.data(), static_cast<std::streamsize>(buffer_.size()));
+        buffer_.clear();
+        return file_.good();
+    }
+
+private:
+    static constexpr size_t buffer_size = 1 << 20;
+    std::ofstream file_;
+    bool binary_;
+    std::string buffer_;
+};
+
+/**
+ * Function to compute personalized PageRank for all seed sets in batches of PPR_BATCH_WIDTH.
+ *
+ * A summary of every seed set is printed and, if an output file is given, the values of all seed sets are streamed to
+ * it batch by batch, so the memory stays bounded by one batch regardless of the number of seed sets. The text format
+ * has one "seed_set node rank" line per value, the binary format has the record count (uint64) followed by
+ * (int32 seed set, int32 node, double rank) records. Seed sets without any node of the graph are skipped with a
+ * warning, the remaining ones keep their index in the file.
+ *
+ * @param csr The CSR representation of the graph.
+ * @param seed_sets The seed sets (original node IDs).
+ * @param output_filename The name of the file to export the values to, empty for no export.
+ * @param binary True for the binary format, false for the text format.
+ * @return True if the values were exported successfully (or no export was requested).
+ */
+bool page_rank_personalized(const CsrGraph &csr,
+                            const std::vector<std::vector<int> > &seed_sets,
+                            const std::string &output_filename,
+                            const bool binary) {
+    constexpr size_t width = PPR_BATCH_WIDTH;
+    const size_t total_nodes = csr.node_count();
+
+    std::vector<size_t> valid_sets; // Indices of the seed sets with at least one node of the graph
+    for (size_t k = 0; k < seed_sets.size(); ++k) {
+        if (std::any_of(seed_sets[k].begin(), seed_sets[k].end(), [total_nodes](const int seed) {
+            return seed >= 0 && static_cast<size_t>(seed) < total_nodes;
+        })) {
+            valid_sets.push_back(k);
+        } else {
+            std::cerr << "Warning: seed set " << k << " has no node of the graph, skipping it" << std::endl;
+        }
+    }
+
+    std::unique_ptr<RankRecordWriter> writer;
+    if (!output_filename.empty()) {
+        writer = std::make_unique<RankRecordWriter>(output_filename, binary, valid_sets.size() * total_nodes);
+        if (!writer->is_open()) {
+            return false;
+        }
+    }
+
+    for (size_t batch_start = 0; batch_start < valid_sets.size(); batch_start += width) {
+        const size_t batch_end = std::min(batch_start + width, valid_sets.size());
+        std::vector<std::vector<int> > batch;
+        for (size_t j = batch_start; j < batch_end; ++j) {
+            batch.push_back(seed_sets[valid_sets[j]]);
+        }
+
+        const std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+        std::vector<int> converged_iterations;
+        const std::vector<double> page_rank = page_rank_personalized_batch(csr, batch, converged_iterations);
+        const std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+        std::cout << "Batch of seed sets " << valid_sets[batch_start] << "-" << valid_sets[batch_end - 1] << ": "
+                << std::chrono::duration_cast<std::chrono::milliseconds>(end - begin).count() << "ms" << std::endl;
+
+        for (size_t k = 0; k < batch.size(); ++k) {
+            const auto seed_set = static_cast<int32_t>(valid_sets[batch_start + k]);
+
+            // Find the best node of the seed set
+            size_t best = 0;
+            for (size_t i = 1; i < total_nodes; ++i) {
+                if (page_rank[i * width + k] > page_rank[best * width + k]) {
+                    best = i;
+                }
+            }
+            std::cout << "Seed set " << seed_set << ": ";
+            if (converged_iterations[k] > 0) {
+                std::cout << "converged in " << converged_iterations[k] << " iterations";
+            } else {
+                std::cout << "did not converge";
+            }
+            std::cout << ", top node " << csr.original_ids[best] << ": " << page_rank[best * width + k] << std::endl;
+
+            if (writer) {
+                for (size_t i = 0; i < total_nodes; ++i) {
+                    writer->write({seed_set, csr.original_ids[i]}, page_rank[i * width + k]);
+                }
+            }
+        }
+    }
+
+    return !writer || writer->finish();
+}
+
+#ifdef PAGE_RANK_MPI
+/**
+ * Function to exchange variable-sized batches of values between all processes (MPI_Alltoallv).
+ *
+ * @param send_buffers The values to send to every process, indexed by the rank of the receiver.
+ * @param datatype The MPI datatype matching T.
+ * @return The values received from all processes, concatenated in the order of their ranks.
+ */
+template<typename T>
+std::vector<T> exchange_all_to_all(const std::vector<std::vector<T> > &send_buffers, const MPI_Datatype datatype) {
+    const int num_processes = static_cast<int>(send_buffers.size());
+    std::vector<int> send_counts(num_processes), send_displacements(num_processes);
+    std::vector<int> receive_counts(num_processes), receive_displacements(num_processes);
+
+    std::vector<T> send_data;
+    for (int q = 0; q < num_processes; ++q) {
+        send_displacements[q] = static_cast<int>(send_data.size());
+        send_counts[q] = static_cast<int>(send_buffers[q].size());
+        send_data.insert(send_data.end(), send_buffers[q].begin(), send_buffers[q].end());
+    }
+
+    MPI_Alltoall(send_counts.data(), 1, MPI_INT, receive_counts.data(), 1, MPI_INT, MPI_COMM_WORLD);
+    int total_received = 0;
+    for (int q = 0; q < num_processes; ++q) {
+        receive_displacements[q] = total_received;
+        total_received += receive_counts[q];
+    }
+
+    std::vector<T> received(total_received);
+    MPI_Alltoallv(send_data.data(), send_counts.data(), send_displacements.data(), datatype,
+                  received.data(), receive_counts.data(), receive_displacements.data(), datatype, MPI_COMM_WORLD);
+    return received;
+}
+
+/**
+ * Function to compute the PageRank values with several MPI processes, each owning a block of the vertices.
+ *
+ * Every process reads its own part of the file and sends each edge to the owner of its target, so it holds the
+ * incoming edges of its vertices only. In every iteration each process computes the contributions PR(v) / |N+(v)| of
+ * its vertices, sends the ones needed by other processes (boundary vertices) in one batched MPI_Alltoallv and then
+ * computes the new PageRank values of its vertices. The compute and communication time of every iteration is reported.
+ *
+ * @param filename The name of the file to read from.
+ * @param damping_factor The damping factor used in the PageRank calculation.
+ * @param threshold The convergence threshold.
+ * @param max_iterations The maximum number of iterations.
+ * @return The PageRank values for each node on rank 0, empty on the other ranks.
+ */
+std::vector<double> page_rank_mpi(const std::string &filename,
+                                  const double damping_factor = DAMPING_FACTOR,
+                                  const double threshold = EPSILON,
+                                  const int max_iterations = MAX_ITERATIONS) {
+    int rank, num_processes;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &num_processes);
+
+    // Every process loads its chunk of the file, the boundaries are computed the same way as in load_data()
+    std::ifstream file(filename, std::ios::ate | std::ios::binary);
+    if (!file.is_open()) {
+        std::cerr << "Error opening file: " << filename << std::endl;
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+    const std::streampos file_size = file.tellg();
+    const long chunk_size = file_size / num_processes;
+    const auto chunk_boundary = [&](const int i) -> std::streampos {
+        if (i == 0) {
+            return 0;
+        }
+        if (i == num_processes) {
+            return file_size;
+        }
+        file.seekg(i * chunk_size);
+        std::string dummy;
+        std::getline(file, dummy);
+        return file.tellg();
+    };
+    const std::streampos start_pos = chunk_boundary(rank);
+    const std::streampos end_pos = chunk_boundary(rank + 1);
+    file.close();
+
+    AdjacencyList local_graph;
+    load_data_worker(filename, start_pos, end_pos, local_graph);
+
+    // Total number of nodes, every endpoint is counted by the owner of a block of the whole ID range
+    int local_max_id = -1;
+    for (const auto &[source, targets]: local_graph.n_minus) {
+        local_max_id = std::max(local_max_id, source);
+        for (const int target: targets) {
+            local_max_id = std::max(local_max_id, target);
+        }
+    }
+    int max_id = -1;
+    MPI_Allreduce(&local_max_id, &max_id, 1, MPI_INT, MPI_MAX, MPI_COMM_WORLD);
+
+    const long id_block = (static_cast<long>(max_id) + num_processes) / num_processes;
+    std::vector<std::vector<int> > endpoint_buffers(num_processes);
+    for (const auto &[source, targets]: local_graph.n_minus) {
+        endpoint_buffers[source / id_block].push_back(source);
+        for (const int target: targets) {
+            endpoint_buffers[target / id_block].push_back(target);
+        }
+    }
+    std::vector<char> seen(id_block, 0);
+    for (const int id: exchange_all_to_all(endpoint_buffers, MPI_INT)) {
+        seen[id - rank * id_block] = 1;
+    }
+    long local_seen = std::count(seen.begin(), seen.end(), 1);
+    long total_nodes = 0;
+    MPI_Allreduce(&local_seen, &total_nodes, 1, MPI_LONG, MPI_SUM, MPI_COMM_WORLD);
+
+    // Vertices are split into contiguous blocks, the owner of an edge is the owner of its target
+    const long block = (total_nodes + num_processes - 1) / num_processes;
+    const long first = std::min(static_cast<long>(rank) * block, total_nodes);
+    const long local_nodes = std::min(first + block, total_nodes) - first;
+    const auto owner = [block](const int vertex) { return static_cast<int>(vertex / block); };
+
+    std::vector<std::vector<int> > edge_buffers(num_processes);
+    std::vector<std::vector<int> > source_buffers(num_processes);
+    for (const auto &[source, targets]: local_graph.n_minus) {
+        for (const int target: targets) {
+            if (source >= total_nodes || target >= total_nodes) {
+                continue; // Same as in the shared-memory modes, IDs outside of the rank vector are skipped
+            }
+            edge_buffers[owner(target)].push_back(source);
+            edge_buffers[owner(target)].push_back(target);
+            source_buffers[owner(source)].push_back(source);
+        }
+    }
+    local_graph = AdjacencyList();
+    const std::vector<int> local_edges = exchange_all_to_all(edge_buffers, MPI_INT);
+
+    std::vector<int> out_degree(local_nodes, 0);
+    for (const int source: exchange_all_to_all(source_buffers, MPI_INT)) {
+        ++out_degree[source - first];
+    }
+
+    // Incoming edges of the owned vertices in CSR, sources owned by other processes become ghost vertices
+    std::vector<size_t> in_offsets(local_nodes + 1, 0);
+    for (size_t e = 0; e < local_edges.size(); e += 2) {
+        ++in_offsets[local_edges[e + 1] - first + 1];
+    }
+    for (long i = 0; i < local_nodes; ++i) {
+        in_offsets[i + 1] += in_offsets[i];
+    }
+
+    std::vector<std::vector<int> > requests(num_processes); // Ghost vertices needed from every process
+    for (size_t e = 0; e < local_edges.size(); e += 2) {
+        if (const int source = local_edges[e]; owner(source) != rank) {
+            requests[owner(source)].push_back(source);
+        }
+    }
+    std::vector<int> ghost_counts(num_processes), ghost_displacements(num_processes);
+    std::unordered_map<int, int> ghost_index;
+    int ghost_count = 0;
+    for (int q = 0; q < num_processes; ++q) {
+        std::sort(requests[q].begin(), requests[q].end());
+        requests[q].erase(std::unique(requests[q].begin(), requests[q].end()), requests[q].end());
+        ghost_displacements[q] = ghost_count;
+        ghost_counts[q] = static_cast<int>(requests[q].size());
+        for (const int vertex: requests[q]) {
+            ghost_index[vertex] = static_cast<int>(local_nodes) + ghost_count++;
+        }
+    }
+
+    std::vector<int> in_sources(in_offsets[local_nodes]);
+    std::vector<size_t> positions(in_offsets.begin(), in_offsets.end() - 1);
+    for (size_t e = 0; e < local_edges.size(); e += 2) {
+        const int source = local_edges[e];
+        in_sources[positions[local_edges[e + 1] - first]++] = owner(source) == rank
+                                                                  ? static_cast<int>(source - first)
+                                                                  : ghost_index[source];
+    }
+
+    // Tell every process which of its contributions are needed here, the same lists are sent in every iteration
+    const std::vector<int> requested = exchange_all_to_all(requests, MPI_INT);
+    std::vector<int> send_counts(num_processes), send_displacements(num_processes);
+    MPI_Alltoall(ghost_counts.data(), 1, MPI_INT, send_counts.data(), 1, MPI_INT, MPI_COMM_WORLD);
+    for (int q = 0, offset = 0; q < num_processes; offset += send_counts[q], ++q) {
+        send_displacements[q] = offset;
+    }
+
+    // Owned contributions followed by the ghost contributions received from the other processes
+    std::vector<double> contribution(local_nodes + ghost_count, 0.0);
+    std::vector<double> send_buffer(requested.size());
+    std::vector<double> page_rank(local_nodes, 1.0 / static_cast<double>(total_nodes));
+    std::vector<double> new_page_rank(local_nodes, 0.0);
+
+    if (rank == 0) {
+        std::cout << "Processes: " << num_processes << ", total number of nodes: " << total_nodes << std::endl;
+    }
+
+    double total_compute_time = 0.0, total_communication_time = 0.0;
+    int iteration = 0;
+    while (iteration < max_iterations) {
+        double compute_time = 0.0, communication_time = 0.0;
+        double time = MPI_Wtime();
+
+#pragma omp parallel for default(none) shared(page_rank, out_degree, contribution, local_nodes)
+        for (long i = 0; i < local_nodes; ++i) {
+            contribution[i] = out_degree[i] > 0 ? page_rank[i] / out_degree[i] : 0.0;
+        }
+        for (size_t k = 0; k < requested.size(); ++k) {
+            send_buffer[k] = contribution[requested[k] - first];
+        }
+        compute_time += MPI_Wtime() - time;
+
+        // Batched exchange of the boundary contributions
+        time = MPI_Wtime();
+        MPI_Alltoallv(send_buffer.data(), send_counts.data(), send_displacements.data(), MPI_DOUBLE,
+                      contribution.data() + local_nodes, ghost_counts.data(), ghost_displacements.data(), MPI_DOUBLE,
+                      MPI_COMM_WORLD);
+        communication_time += MPI_Wtime() - time;
+
+        time = MPI_Wtime();
+        double local_max_change = 0.0;
+#pragma omp parallel for default(none) shared(in_offsets, in_sources, contribution, page_rank, new_page_rank, \
+    local_nodes, total_nodes, damping_factor) reduction(max: local_max_change)
+        for (long i = 0; i < local_nodes; ++i) {
+            double rank_sum = 0.0;
+            for (size_t e = in_offsets[i]; e < in_offsets[i + 1]; ++e) {
+                rank_sum += contribution[in_sources[e]];
+            }
+            new_page_rank[i] = (1.0 - damping_factor) / static_cast<double>(total_nodes) + damping_factor * rank_sum;
+            local_max_change = std::max(local_max_change, std::fabs(new_page_rank[i] - page_rank[i]));
+        }
+        page_rank.swap(new_page_rank);
+        compute_time += MPI_Wtime() - time;
+
+        time = MPI_Wtime();
+        double max_change = 0.0;
+        MPI_Allreduce(&local_max_change, &max_change, 1, MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD);
+        communication_time += MPI_Wtime() - time;
+        ++iteration;
+
+        // Report the slowest process, it determines the length of the iteration
+        double times[2] = {compute_time, communication_time}, max_times[2];
+        MPI_Reduce(times, max_times, 2, MPI_DOUBLE, MPI_MAX, 0, MPI_COMM_WORLD);
+        if (rank == 0) {
+            total_compute_time += max_times[0];
+            total_communication_time += max_times[1];
+            std::cout << "Iteration " << iteration << ": compute " << max_times[0] * 1000.0 << "ms, communication "
+                    << max_times[1] * 1000.0 << "ms" << std::endl;
+        }
+
+        if (max_change < threshold) {
+            if (rank == 0) {
+                std::cout << "Converged in " << iteration << " iterations." << std::endl;
+            }
+            break;
+        }
+    }
+
+    long boundary_values = static_cast<long>(requested.size()), total_boundary_values = 0;
+    MPI_Reduce(&boundary_values, &total_boundary_values, 1, MPI_LONG, MPI_SUM, 0, MPI_COMM_WORLD);
+    if (rank == 0) {
+        std::cout << "Total compute time: " << total_compute_time * 1000.0 << "ms, total communication time: "
+                << total_communication_time * 1000.0 << "ms, boundary values per iteration: "
+                << total_boundary_values << std::endl;
+    }
+
+    // Gather the blocks of all processes on rank 0
+    std::vector<int> block_counts(num_processes), block_displacements(num_processes);
+    const int local_count = static_cast<int>(local_nodes);
+    MPI_Gather(&local_count, 1, MPI_INT, block_counts.data(), 1, MPI_INT, 0, MPI_COMM_WORLD);
+    for (int q = 0, offset = 0; q < num_processes; offset += block_counts[q], ++q) {
+        block_displacements[q] = offset;
+    }
+    std::vector<double> result(rank == 0 ? total_nodes : 0);
+    MPI_Gatherv(page_rank.data(), local_count, MPI_DOUBLE, result.data(), block_counts.data(),
+                block_displacements.data(), MPI_DOUBLE, 0, MPI_COMM_WORLD);
+
+    return result;
+}
+#endif
+
+/**
+ * Function to print the top N nodes with the highest PageRank values.
+ *
+ * Every thread keeps a bounded min-heap of its N best nodes, the heaps are merged at the end, so only N entries per
+ * thread are allocated and sorted instead of the whole rank vector.
+ *
+ * @param page_rank The PageRank values for each node.
+ * @param top_n The number of top nodes to print.
+ * @param original_ids The original node ID of every PageRank value if the vertices were relabelled, empty otherwise.
+ */
+void print_top_n_nodes(const std::vector<double> &page_rank,
+                       const size_t top_n = 10,
+                       const std::vector<int> &original_ids = {}) {
+    // Min-heap ordering, the node with the lowest PageRank is on top and is the first one to be replaced
+    const auto higher_rank = [](const std::pair<int, double> &a, const std::pair<int, double> &b) {
+        return b.second < a.second;
+    };
+    std::vector<std::pair<int, double> > node_ranks;
+    const long total_nodes = static_cast<long>(page_rank.size());
+
+#pragma omp parallel default(none) shared(page_rank, top_n, original_ids, higher_rank, node_ranks, total_nodes)
+    {
+        std::vector<std::pair<int, double> > local_heap;
+        local_heap.reserve(top_n + 1);
+
+#pragma omp for nowait
+        for (long i = 0; i < total_nodes; ++i) {
+            if (local_heap.size() == top_n && (top_n == 0 || page_rank[i] <= local_heap.front().second)) {
+                continue;
+            }
+            local_heap.emplace_back(original_ids.empty() ? static_cast<int>(i) : original_ids[i], page_rank[i]);
+            std::push_heap(local_heap.begin(), local_heap.end(), higher_rank);
+            if (local_heap.size() > top_n) {
+                std::pop_heap(local_heap.begin(), local_heap.end(), higher_rank);
+                local_heap.pop_back();
+            }
+        }
+
+#pragma omp critical
+        node_ranks.insert(node_ranks.end(), local_heap.begin(), local_heap.end());
+    }
+
+    // Sort the merged candidates by PageRank value in descending order
+    const size_t count = std::min(top_n, node_ranks.size());
+    std::partial_sort(node_ranks.begin(), node_ranks.begin() + static_cast<long>(count), node_ranks.end(), higher_rank);
+
+    std::cout << "Top " << top_n << " nodes with highest PageRank:" << std::endl;
+
+    // Print the top N nodes with the highest PageRank values
+    for (size_t i = 0; i < count; ++i) {
+        std::cout << "Node " << node_ranks[i].first << ": " << node_ranks[i].second << std::endl;
+    }
+}
+
+/**
+ * Function to stream all PageRank values to a file without building a sorted copy.
+ *
+ * The values are written in vertex order through a fixed-size buffer. The text format has one "node rank" line per
+ * node, the binary format has the node count (uint64) followed by (int32 node, double rank) records.
+ *
+ * @param filename The name of the file to write to.
+ * @param page_rank The PageRank values for each node.
+ * @param binary True for the binary format, false for the text format.
+ * @param original_ids The original node ID of every PageRank value if the vertices were relabelled, empty otherwise.
+ * @return True if the values were written successfully.
+ */
+bool export_page_rank(const std::string &filename,
+                      const std::vector<double> &page_rank,
+                      const bool binary,
+                      const std::vector<int> &original_ids = {}) {
+    RankRecordWriter writer(filename, binary, page_rank.size());
+    if (!writer.is_open()) {
+        return false;
+    }
+
+    for (size_t i = 0; i < page_rank.size(); ++i) {
+        const int32_t node = original_ids.empty() ? static_cast<int32_t>(i) : original_ids[i];
+        writer.write({node}, page_rank[i]);
+    }
+
+    return writer.finish();
+}
+
+#ifndef BENCHMARK_KERNELS_ONLY
+int main(int argc, char *argv[]) {
+    // Usage: ./page_rank [pull|delta] [graph_file]
+    //        ./page_rank incremental [graph_file] [updates_file] [rank_file]
+    //        ./page_rank reorder [graph_file] [original|degree|bfs|rcm]
+    //        ./page_rank blocked [graph_file] [partition_vertices]
+    //        ./page_rank personalized [graph_file] [seeds_file]
+    //        mpirun -np <processes> ./page_rank_mpi mpi [graph_file]
+    // Every mode accepts --output <file> [--format text|binary] to export all PageRank values
+    std::vector<std::string> args;
+    std::string output_filename;
+    std::string output_format = "text";
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg == "--output" && i + 1 < argc) {
+            output_filename = argv[++i];
+        } else if (arg == "--format" && i + 1 < argc) {
+            output_format = argv[++i];
+        } else {
+            args.push_back(arg);
+        }
+    }
+    if (output_format != "text" && output_format != "binary") {
+        std::cerr << "Unknown output format: " << output_format << std::endl;
+        return 1;
+    }
+
+    const std::string mode = !args.empty() ? args[0] : "pull";
+    const std::string filename = args.size() > 1 ? args[1] : "../project_3/web-BerkStan.txt";
+
+#ifdef PAGE_RANK_MPI
+    if (mode == "mpi") {
+        // The OpenMP loops run between MPI calls, which are made only by the master thread
+        int provided;
+        MPI_Init_thread(&argc, &argv, MPI_THREAD_FUNNELED, &provided);
+        int rank;
+        MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+        if (provided < MPI_THREAD_FUNNELED) {
+            if (rank == 0) {
+                std::cerr << "The MPI library does not support MPI_THREAD_FUNNELED" << std::endl;
+            }
+            MPI_Abort(MPI_COMM_WORLD, 1);
+        }
+
+        const double begin_page_rank = MPI_Wtime();
+        const std::vector<double> page_rank_values = page_rank_mpi(filename);
+        if (rank == 0) {
+            std::cout << "Time for loading data and PageRank (mpi): " << (MPI_Wtime() - begin_page_rank) * 1000.0
+                    << "ms" << std::endl;
+            print_top_n_nodes(page_rank_values);
+            if (!output_filename.empty()) {
+                export_page_rank(output_filename, page_rank_values, output_format == "binary");
+            }
+        }
+
+        MPI_Finalize();
+        return 0;
+    }
+#endif
+
+    const std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+    AdjacencyList all_vertices = load_data(filename);
+    const std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+
+    std::cout << "Time for loading data: " << std::chrono::duration_cast<std::chrono::milliseconds>(end - begin).count()
+            << "ms" << std::endl;
+    size_t total_node_count = get_total_node_count(all_vertices);
+    std::cout << "Total number of nodes: " << total_node_count << std::endl;
+
+    const std::chrono::steady_clock::time_point begin_page_rank = std::chrono::steady_clock::now();
+    std::vector<double> page_rank_values;
+    std::vector<int> original_ids; // Filled only by the modes that relabel the vertices
+    if (mode == "pull") {
+        page_rank_values = page_rank(all_vertices, total_node_count);
+    } else if (mode == "delta") {
+        const CsrGraph csr = build_csr(all_vertices, compute_vertex_order(all_vertices, total_node_count, "original"));
+        page_rank_values = page_rank_delta(csr);
+    } else if (mode == "incremental") {
+        const std::string updates_filename = args.size() > 2 ? args[2] : "../project_3/edge-updates.txt";
+        const std::string rank_filename = args.size() > 3 ? args[3] : "../project_3/page-rank.bin";
+
+        const std::vector<EdgeUpdate> updates = load_edge_updates(updates_filename);
+        if (updates.empty()) {
+            std::cerr << "No edge updates in " << updates_filename << std::endl;
+            return 1;
+        }
+
+        // The saved ranks have to belong to the graph before the updates, otherwise start with a cold run on it
+        std::vector<double> previous_page_rank = load_page_rank(rank_filename);
+        if (previous_page_rank.empty()) {
+            std::cout << "No previous PageRank values in " << rank_filename << ", computing them from scratch"
+                    << std::endl;
+        } else if (previous_page_rank.size() != total_node_count) {
+            std::cerr << "Warning: " << rank_filename << " holds PageRank values of " << previous_page_rank.size()
+                    << " nodes, but the graph has " << total_node_count << ", computing them from scratch"
+                    << std::endl;
+            previous_page_rank.clear();
+        }
+        if (previous_page_rank.empty()) {
+            previous_page_rank = page_rank_delta(build_csr(all_vertices, compute_vertex_order(
+                all_vertices, total_node_count, "original")));
+        }
+
+        const std::vector<int> affected = apply_edge_updates(all_vertices, updates);
+        total_node_count = get_total_node_count(all_vertices);
+        std::cout << "Applied " << updates.size() << " edge updates, total number of nodes: " << total_node_count
+                << std::endl;
+
+        const CsrGraph csr = build_csr(all_vertices, compute_vertex_order(all_vertices, total_node_count, "original"));
+        page_rank_values = page_rank_incremental(csr, previous_page_rank, affected);
+        if (!save_page_rank(rank_filename, page_rank_values)) {
+            std::cerr << "Error writing PageRank values to " << rank_filename << std::endl;
+            return 1;
+        }
+    } else if (mode == "reorder") {
+        const std::string order_name = args.size() > 2 ? args[2] : "degree";
+        page_rank_values = page_rank_reordered(all_vertices, total_node_count, order_name, original_ids);
+        if (page_rank_values.empty()) {
+            return 1;
+        }
+    } else if (mode == "blocked") {
+        size_t partition_size = BLOCK_PARTITION_BYTES / sizeof(double);
+        if (args.size() > 2) {
+            size_t parsed_length = 0;
+            try {
+                partition_size = std::stoul(args[2], &parsed_length);
+            } catch (const std::exception &) {
+                parsed_length = 0;
+            }
+            if (parsed_length != args[2].size() || partition_size == 0) {
+                std::cerr << "Invalid partition size: " << args[2] << std::endl;
+                return 1;
+            }
+        }
+        const CsrGraph csr = build_csr(all_vertices, compute_vertex_order(all_vertices, total_node_count, "original"));
+        page_rank_values = page_rank_blocked(csr, partition_size);
+    } else if (mode == "personalized") {
+        const std::string seeds_filename = args.size() > 2 ? args[2] : "../project_3/seed-sets.txt";
+        const std::vector<std::vector<int> > seed_sets = load_seed_sets(seeds_filename);
+        if (seed_sets.empty()) {
+            return 1;
+        }
+        const CsrGraph csr = build_csr(all_vertices, compute_vertex_order(all_vertices, total_node_count, "original"));
+        // Every seed set has its own values, they are summarized and exported by the batches themselves
+        if (!page_rank_personalized(csr, seed_sets, output_filename, output_format == "binary")) {
+            return 1;
+        }
+    } else {
+        std::cerr << "Unknown mode: " << mode << std::endl;
+        return 1;
+    }
+    const std::chrono::steady_clock::time_point end_page_rank = std::chrono::steady_clock::now();
+    // The reorder mode reports both of its runs on their own, here its reordering and both runs are included
+    const std::string time_name = mode == "reorder"
+                                      ? "reordering and PageRank in both orders"
+                                      : "PageRank (" + mode + ")";
+    std::cout << "Time for " << time_name << ": " << std::chrono::duration_cast<std::chrono::milliseconds>(
+        end_page_rank - begin_page_rank).count() << "ms" << std::endl;
+
+    if (mode != "personalized") {
+        print_top_n_nodes(page_rank_values, 10, original_ids);
+    }
+
+    if (!output_filename.empty() && mode != "personalized") {
+        const std::chrono::steady_clock::time_point begin_export = std::chrono::steady_clock::now();
+        if (!export_page_rank(output_filename, page_rank_values, output_format == "binary", original_ids)) {
+            return 1;
+        }
+        const std::chrono::steady_clock::time_point end_export = std::chrono::steady_clock::now();
+        std::cout << "Time for exporting PageRank to " << output_filename << ": "
+                << std::chrono::duration_cast<std::chrono::milliseconds>(end_export - begin_export).count() << "ms"
+                << std::endl;
+    }
 
-    print_top_n_nodes(page_rank_values);
+    print_phase_summary(std::cout);
 
     return 0;
 }
+#endif
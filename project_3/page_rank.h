@@ -0,0 +1,89 @@
+#ifndef PAGE_RANK_H
+#define PAGE_RANK_H
+
+#include <cstddef>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#define DAMPING_FACTOR 0.85
+#define EPSILON 1e-6
+#define MAX_ITERATIONS 100
+#define BLOCK_PARTITION_BYTES (256 * 1024) ///< Size of the rank values of one destination partition, fits in L2
+#define PPR_BATCH_WIDTH 8 ///< Number of personalized PageRank vectors iterated at once (lanes of a row)
+#define DELTA_TOLERANCE_PER_NODE (EPSILON / 30) ///< Default bound on the L1 error of the delta modes per vertex
+#define DELTA_PULL_FRACTION 0.1 ///< Share of the edges above which a delta iteration pulls instead of pushing
+#define MAX_DELTA_ITERATIONS 1000 ///< Delta iterations are cheap once the frontier shrinks, so allow more of them
+
+/**
+ * Structure to hold the adjacency list representation of the graph.
+ */
+struct AdjacencyList {
+    std::unordered_map<int, std::vector<int> > n_minus; ///< Map of nodes to their incoming neighbors.
+    std::unordered_map<int, std::vector<int> > n_plus; ///< Map of nodes to their outgoing neighbors.
+};
+
+/**
+ * Structure to hold a single edge insertion or removal.
+ */
+struct EdgeUpdate {
+    int source; ///< Source node of the edge.
+    int target; ///< Target node of the edge.
+    bool insert; ///< True for insertion, false for removal.
+};
+
+/**
+ * Structure to hold the compressed sparse row (CSR) representation of the graph.
+ *
+ * Vertices are numbered 0..n-1, possibly in a different order than in the input file (see compute_vertex_order()).
+ */
+struct CsrGraph {
+    std::vector<size_t> in_offsets; ///< Offsets of the incoming edges of every vertex into in_sources (size n + 1).
+    std::vector<int> in_sources; ///< Sources of the incoming edges, grouped by target.
+    std::vector<size_t> out_offsets; ///< Offsets of the outgoing edges of every vertex into out_targets (size n + 1).
+    std::vector<int> out_targets; ///< Targets of the outgoing edges, grouped by source.
+    std::vector<int> original_ids; ///< Original node ID of every vertex.
+
+    [[nodiscard]] size_t node_count() const { return original_ids.size(); }
+    [[nodiscard]] size_t out_degree(const int vertex) const { return out_offsets[vertex + 1] - out_offsets[vertex]; }
+};
+
+// Loading of the graph
+AdjacencyList load_data(const std::string &filename, long num_threads);
+size_t get_total_node_count(const AdjacencyList &all_vertices);
+
+// Pull PageRank on the adjacency list and its updates
+std::vector<double> page_rank(const AdjacencyList &graph, size_t total_nodes, double damping_factor, double threshold,
+                              int max_iterations);
+std::vector<EdgeUpdate> load_edge_updates(const std::string &filename);
+std::vector<int> apply_edge_updates(AdjacencyList &graph, const std::vector<EdgeUpdate> &updates);
+bool save_page_rank(const std::string &filename, const std::vector<double> &page_rank);
+std::vector<double> load_page_rank(const std::string &filename);
+
+// Push (delta) and incremental PageRank on the CSR representation
+std::vector<double> page_rank_delta(const CsrGraph &csr, double damping_factor, double tolerance, int max_iterations);
+std::vector<double> page_rank_incremental(const CsrGraph &csr, const std::vector<double> &previous_page_rank,
+                                          std::vector<int> affected, double damping_factor, double tolerance,
+                                          int max_iterations);
+
+// PageRank on the CSR representation
+std::vector<int> compute_vertex_order(const AdjacencyList &graph, size_t total_nodes, const std::string &order_name);
+CsrGraph build_csr(const AdjacencyList &graph, const std::vector<int> &order);
+std::vector<double> page_rank_csr(const CsrGraph &csr, double damping_factor, double threshold, int max_iterations);
+std::vector<double> page_rank_blocked(const CsrGraph &csr, size_t partition_size, double damping_factor,
+                                      double threshold, int max_iterations);
+std::vector<double> page_rank_reordered(const AdjacencyList &graph, size_t total_nodes, const std::string &order_name,
+                                        std::vector<int> &original_ids);
+std::vector<std::vector<int> > load_seed_sets(const std::string &filename);
+std::vector<double> page_rank_personalized_batch(const CsrGraph &csr, const std::vector<std::vector<int> > &seed_sets,
+                                                 std::vector<int> &converged_iterations, double damping_factor,
+                                                 double threshold, int max_iterations);
+bool page_rank_personalized(const CsrGraph &csr, const std::vector<std::vector<int> > &seed_sets,
+                            const std::string &output_filename, bool binary);
+
+// Output of the results
+void print_top_n_nodes(const std::vector<double> &page_rank, size_t top_n, const std::vector<int> &original_ids);
+bool export_page_rank(const std::string &filename, const std::vector<double> &page_rank, bool binary,
+                      const std::vector<int> &original_ids);
+
+#endif // PAGE_RANK_H